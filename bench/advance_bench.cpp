@@ -0,0 +1,180 @@
+// advance_bench：車輛沿長路徑前進一格的成本
+//   在產生的大停車場上取一條最長的最短路徑 (BFS)，截成不同長度 L，
+//   路徑上隨機放 K 個 waitTime 非 0 的格子 (別台車的終點)，每一步改動其中一格的值
+//   比較原本的「path.erase(begin) + 整條剩餘路徑重算 Σ max(wait - k, 0)」(每步 O(L))
+//   與 PathCursor (游標前進 + 只算等待中的格子)，兩者每一步算出的和必須相同
+//
+// 參數：[--rows R] [--cols C] [--waiting K] [--trips N] [--lengths 100,500,...]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lot_layout.hpp"
+#include "path_cursor.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+using Cell = pair<int, int>;
+
+// 從入口出發 BFS，回傳到最遠通道格的最短路徑
+static vector<Cell> longestRoute(const LotLayout &layout) {
+    int rows = layout.rows, cols = layout.cols;
+    auto open = [&](int r, int c) {
+        LayoutCell t = layout.at(r, c);
+        return t != LayoutCell::Wall && t != LayoutCell::Stall;
+    };
+    Cell start = layout.entrances.empty() ? Cell(0, 0) : layout.entrances[0];
+    vector<int> parent((size_t)rows * cols, -2);
+    queue<int> q;
+    int s = start.first * cols + start.second, last = s;
+    parent[s] = -1;
+    q.push(s);
+    const int dr[4] = {-1, 1, 0, 0}, dc[4] = {0, 0, -1, 1};
+    while (!q.empty()) {
+        int cur = q.front();
+        q.pop();
+        last = cur;
+        int r = cur / cols, c = cur % cols;
+        for (int d = 0; d < 4; ++d) {
+            int nr = r + dr[d], nc = c + dc[d];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols || !open(nr, nc)) continue;
+            int n = nr * cols + nc;
+            if (parent[n] != -2) continue;
+            parent[n] = cur;
+            q.push(n);
+        }
+    }
+    vector<Cell> path;
+    for (int cur = last; cur != -1; cur = parent[cur]) path.emplace_back(cur / cols, cur % cols);
+    return vector<Cell>(path.rbegin(), path.rend());
+}
+
+struct Result {
+    double nsPerStep;
+    long long checksum;
+};
+
+// 每一步要改的 (位置, 新值)：兩種做法用同一份
+struct Workload {
+    vector<size_t> waitingAt;          // 等待中的格子在路徑上的位置
+    vector<pair<size_t, int>> updates; // 第 i 步：waitingAt[first] 改成 second
+};
+
+static Workload makeWorkload(size_t len, int waiting, mt19937 &eng) {
+    Workload w;
+    for (int k = 0; k < waiting && len > 1; ++k) w.waitingAt.push_back(eng() % (len - 1));
+    for (size_t i = 0; i < len; ++i) {
+        if (w.waitingAt.empty()) break;
+        w.updates.emplace_back(eng() % w.waitingAt.size(), 1 + (int)(eng() % 40));
+    }
+    return w;
+}
+
+// 原本的做法：erase + 整條重掃
+static Result runErase(const vector<Cell> &route, const Workload &w, int cols, vector<int> &wait, int trips) {
+    long long checksum = 0, steps = 0;
+    auto t0 = steady_clock::now();
+    for (int t = 0; t < trips; ++t) {
+        vector<Cell> path = route;
+        for (size_t i = 0; i < w.waitingAt.size(); ++i) {
+            const Cell &c = route[w.waitingAt[i]];
+            wait[c.first * cols + c.second] = 5 + (int)i;
+        }
+        for (size_t step = 0; path.size() > 1; ++step) {
+            if (step < w.updates.size()) {
+                const Cell &c = route[w.waitingAt[w.updates[step].first]];
+                wait[c.first * cols + c.second] = w.updates[step].second;
+            }
+            path.erase(path.begin());
+            int wtSum = 0;
+            for (size_t k = 0; k + 1 < path.size(); ++k) {
+                int cw = wait[path[k].first * cols + path[k].second];
+                if (cw != 0) wtSum += max(cw - (int)k, 0);
+            }
+            checksum += (long long)path.size() + 9 + wtSum;
+            ++steps;
+        }
+        for (size_t p : w.waitingAt) wait[route[p].first * cols + route[p].second] = 0;
+    }
+    double ns = (double)duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+    return Result{steps ? ns / steps : 0.0, checksum};
+}
+
+// PathCursor：游標前進 + 只算等待中的格子；waitTime 由 0 變非 0 時 markWaiting
+static Result runCursor(const vector<Cell> &route, const Workload &w, int cols, vector<int> &wait, int trips) {
+    long long checksum = 0, steps = 0;
+    auto waitOf = [&](int r, int c) { return wait[r * cols + c]; };
+    auto t0 = steady_clock::now();
+    for (int t = 0; t < trips; ++t) {
+        PathCursor path(route);
+        path.rebuildWaits(waitOf);
+        for (size_t i = 0; i < w.waitingAt.size(); ++i) {
+            const Cell &c = route[w.waitingAt[i]];
+            wait[c.first * cols + c.second] = 5 + (int)i;
+            path.markWaiting(c.first, c.second);
+        }
+        for (size_t step = 0; path.size() > 1; ++step) {
+            if (step < w.updates.size()) {
+                const Cell &c = route[w.waitingAt[w.updates[step].first]];
+                wait[c.first * cols + c.second] = w.updates[step].second;
+            }
+            path.advance();
+            checksum += (long long)path.size() + 9 + path.waitSum(waitOf);
+            ++steps;
+        }
+        for (size_t p : w.waitingAt) wait[route[p].first * cols + route[p].second] = 0;
+    }
+    double ns = (double)duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+    return Result{steps ? ns / steps : 0.0, checksum};
+}
+
+int main(int argc, char *argv[]) {
+    int rows = 1000, cols = 1000, waiting = 8, trips = 20;
+    vector<int> lengths = {100, 250, 500, 1000, 1500};
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        if (arg == "--rows" && a + 1 < argc) rows = atoi(argv[++a]);
+        else if (arg == "--cols" && a + 1 < argc) cols = atoi(argv[++a]);
+        else if (arg == "--waiting" && a + 1 < argc) waiting = atoi(argv[++a]);
+        else if (arg == "--trips" && a + 1 < argc) trips = atoi(argv[++a]);
+        else if (arg == "--lengths" && a + 1 < argc) {
+            lengths.clear();
+            stringstream ss(argv[++a]);
+            string item;
+            while (getline(ss, item, ',')) lengths.push_back(atoi(item.c_str()));
+        }
+    }
+    if (trips < 1) trips = 1;
+
+    LotLayout layout = generateLotLayout(rows, cols);
+    vector<Cell> route = longestRoute(layout);
+    vector<int> wait((size_t)rows * cols, 0);
+    cout << "lot " << rows << "x" << cols << ", longest route " << route.size() << " cells, " << waiting
+         << " waiting cell(s), " << trips << " trip(s) per point\n";
+    printf("%8s %16s %16s %8s\n", "length", "erase ns/step", "cursor ns/step", "speedup");
+    mt19937 eng(1234);
+    for (int len : lengths) {
+        if (len < 2 || len > (int)route.size()) {
+            cout << len << " cells: route too short\n";
+            continue;
+        }
+        vector<Cell> sub(route.begin(), route.begin() + len);
+        Workload w = makeWorkload(sub.size(), waiting, eng);
+        Result a = runErase(sub, w, cols, wait, trips);
+        Result b = runCursor(sub, w, cols, wait, trips);
+        if (a.checksum != b.checksum) {
+            cout << len << " cells: checksum mismatch (" << a.checksum << " vs " << b.checksum << ")\n";
+            return 1;
+        }
+        printf("%8d %16.1f %16.1f %7.2fx\n", len, a.nsPerStep, b.nsPerStep,
+               b.nsPerStep > 0 ? a.nsPerStep / b.nsPerStep : 0.0);
+    }
+    return 0;
+}
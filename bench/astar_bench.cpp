@@ -0,0 +1,326 @@
+// astar_bench：規劃器效能 (傳統 A* vs 改良 A*)
+//   在產生的停車場上掃過「地圖尺寸 × 擁擠程度 × 封閉通道數 × 規劃器變體」，每組跑同一批查詢
+//   (入口 -> 車位旁的通道，或反過來)，量測 queries/s、展開節點數、每次查詢的記憶體配置次數
+//   與延遲百分位數
+//   搜尋是 grid_astar.hpp 的 gridAStar，也就是 250604statisticlog 的 aStar 與 250919repath 的
+//   aStarWithReturn 所呼叫的同一個核心 (相同的成本規則與 JPS 停點)；地圖採用 statisticlog 的 pass class，
+//   不含路線快取 (查詢全部是 miss)、行駛中的車輛與 repath 的迴轉限制
+//   變體：plain = Manhattan、jps = --jps、alt = --alt (入口 + 四角 landmark)、alt+jps = 兩者
+//   擁擠程度 = 通道格中 waitTime > 0 的比例 (值 1~40，相當於其他車的終點等待)；
+//   改良 A* 走進這些格子時多付 max(waitTime - g, 0)
+//
+// 參數：[--sizes 13x12,100x100,500x500,2000x2000] [--density 0,0.02,0.1] [--closures 0,16,256]
+//       [--variants plain,jps,alt,alt+jps] [--queries N] [--seed S] [--csv FILE]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "grid_astar.hpp"
+#include "landmarks.hpp"
+#include "lot_grid.hpp"
+#include "lot_layout.hpp"
+#include "search_context.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+// 配置次數：取代全域 operator new / delete 的所有形式 (單一、陣列、sized、nothrow、aligned)，查詢前後相減
+//   全部經過 countedAlloc / free，new 與 delete 的配對不會混用不同的配置器
+static atomic<uint64_t> allocCount{0};
+
+static void *countedAlloc(size_t n, size_t align = 0) {
+    allocCount.fetch_add(1, memory_order_relaxed);
+    if (n == 0) n = 1;
+    if (align <= alignof(max_align_t)) return malloc(n);
+    return aligned_alloc(align, (n + align - 1) / align * align); // aligned_alloc 要求大小為 align 的倍數
+}
+static void *countedAllocOrThrow(size_t n, size_t align = 0) {
+    if (void *p = countedAlloc(n, align)) return p;
+    throw bad_alloc();
+}
+
+void *operator new(size_t n) { return countedAllocOrThrow(n); }
+void *operator new[](size_t n) { return countedAllocOrThrow(n); }
+void *operator new(size_t n, const nothrow_t &) noexcept { return countedAlloc(n); }
+void *operator new[](size_t n, const nothrow_t &) noexcept { return countedAlloc(n); }
+void *operator new(size_t n, align_val_t a) { return countedAllocOrThrow(n, (size_t)a); }
+void *operator new[](size_t n, align_val_t a) { return countedAllocOrThrow(n, (size_t)a); }
+void *operator new(size_t n, align_val_t a, const nothrow_t &) noexcept { return countedAlloc(n, (size_t)a); }
+void *operator new[](size_t n, align_val_t a, const nothrow_t &) noexcept { return countedAlloc(n, (size_t)a); }
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, const nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, const nothrow_t &) noexcept { free(p); }
+void operator delete(void *p, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, align_val_t) noexcept { free(p); }
+void operator delete(void *p, size_t, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, size_t, align_val_t) noexcept { free(p); }
+void operator delete(void *p, align_val_t, const nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, align_val_t, const nothrow_t &) noexcept { free(p); }
+
+// 與 250604statisticlog 相同的 type 與可通行規則，另加 250919repath 的 CLOSED_AISLE
+enum CellType : uint8_t { ENTRANCE, AISLE, WALL, PARKING_SPACE, VEHICLE, CLOSED_AISLE };
+static constexpr int PASS_DRIVE = 0;  // aStar：通道，或正在移動的車輛
+static constexpr int PASS_STATIC = 1; // ALT：牆、車位、CLOSED_AISLE 以外
+
+struct Variant {
+    string name;
+    bool alt = false;
+    bool jps = false;
+};
+
+struct Query {
+    int sr, sc, er, ec;
+};
+
+struct Scenario {
+    LotGrid grid;
+    pair<int, int> entrance;
+    vector<Query> queries;
+};
+
+static vector<int> parseInts(const string &s) {
+    vector<int> out;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) out.push_back(atoi(item.c_str()));
+    return out;
+}
+
+static vector<double> parseDoubles(const string &s) {
+    vector<double> out;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) out.push_back(atof(item.c_str()));
+    return out;
+}
+
+static vector<Variant> parseVariants(const string &s) {
+    vector<Variant> out;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) {
+        Variant v;
+        v.name = item;
+        v.alt = item.find("alt") != string::npos;
+        v.jps = item.find("jps") != string::npos;
+        if (v.alt || v.jps || item == "plain") out.push_back(v);
+    }
+    return out;
+}
+
+static vector<pair<int, int>> parseSizes(const string &s) {
+    vector<pair<int, int>> out;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t x = item.find('x');
+        if (x == string::npos) continue;
+        out.emplace_back(atoi(item.substr(0, x).c_str()), atoi(item.substr(x + 1).c_str()));
+    }
+    return out;
+}
+
+// 建立一組測試情境：地圖、waitTime、封閉通道、查詢 (同一組 seed => 同一份情境)
+static Scenario makeScenario(int rows, int cols, double density, int closures, int queries, unsigned seed) {
+    Scenario s;
+    LotLayout layout = generateLotLayout(rows, cols);
+    //                     ENTRANCE, AISLE, WALL, PARKING_SPACE, VEHICLE, CLOSED_AISLE
+    s.grid.definePassClass({LotGrid::PASS_NEVER, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER, LotGrid::PASS_NEVER,
+                            LotGrid::PASS_IF_MOVING, LotGrid::PASS_NEVER});
+    s.grid.definePassClass({LotGrid::PASS_ALWAYS, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER, LotGrid::PASS_NEVER,
+                            LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER});
+    s.grid.reset(rows, cols, AISLE);
+
+    vector<pair<int, int>> aisles, goals;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            LayoutCell t = layout.at(r, c);
+            if (t == LayoutCell::Wall) s.grid.setType(r, c, WALL);
+            else if (t == LayoutCell::Stall) s.grid.setType(r, c, PARKING_SPACE);
+            else aisles.emplace_back(r, c);
+        }
+    }
+    for (auto &a : aisles) {
+        const int dr[4] = {-1, 1, 0, 0}, dc[4] = {0, 0, -1, 1};
+        for (int d = 0; d < 4; ++d) {
+            int nr = a.first + dr[d], nc = a.second + dc[d];
+            if (nr >= 0 && nr < rows && nc >= 0 && nc < cols && s.grid.type(nr, nc) == PARKING_SPACE) {
+                goals.push_back(a);
+                break;
+            }
+        }
+    }
+    pair<int, int> entrance = layout.entrances.empty() ? aisles.front() : layout.entrances.front();
+    s.entrance = entrance;
+    if (goals.empty()) goals = aisles;
+
+    mt19937 eng(seed);
+    for (auto &a : aisles) {
+        if (uniform_real_distribution<double>(0.0, 1.0)(eng) < density)
+            s.grid.setWaitTime(a.first, a.second, 1 + (int)(eng() % 40));
+    }
+    for (int k = 0; k < closures && !aisles.empty(); ++k) {
+        pair<int, int> c = aisles[eng() % aisles.size()];
+        if (c != entrance) s.grid.setType(c.first, c.second, CLOSED_AISLE);
+    }
+    for (int q = 0; q < queries; ++q) {
+        pair<int, int> g = goals[eng() % goals.size()];
+        if (q % 2 == 0) s.queries.push_back(Query{entrance.first, entrance.second, g.first, g.second});
+        else s.queries.push_back(Query{g.first, g.second, entrance.first, entrance.second});
+    }
+    return s;
+}
+
+// 一次查詢：與 250604statisticlog 的 aStar 相同的呼叫 (路線快取與 SEARCH_STATS 以外)
+struct ExpansionCounter : SearchHooks {
+    uint64_t expansions = 0;
+    void searched(const SearchContext &ctx) { expansions += ctx.expandedCount(); }
+};
+
+static bool plan(const Scenario &s, const LandmarkHeuristic *alt, const Query &q, const GridAStarConfig &cfg,
+                 vector<pair<int, int>> &path, ExpansionCounter &counter) {
+    auto heuristic = [alt](int r, int c, int er, int ec) {
+        if (alt) return alt->estimate(r, c, er, ec);
+        return abs(er - r) + abs(ec - c);
+    };
+    auto plainCell = [&s](int r, int c) { return s.grid.type(r, c) == VEHICLE; };
+    return gridAStar(s.grid, cfg, q.sr, q.sc, q.er, q.ec, heuristic, plainCell, counter, path);
+}
+
+struct Result {
+    int found = 0;
+    double qps = 0;
+    double avgExpansions = 0;
+    double allocsPerQuery = 0;
+    double p50 = 0, p90 = 0, p99 = 0, maxUs = 0;
+};
+
+static double percentile(const vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[min(i, sorted.size() - 1)];
+}
+
+static Result run(const Scenario &s, const LandmarkHeuristic *alt, bool improved, bool jps) {
+    Result res;
+    GridAStarConfig cfg;
+    cfg.passClass = PASS_DRIVE;
+    cfg.improved = improved;
+    cfg.jps = jps;
+    vector<pair<int, int>> path;
+    ExpansionCounter counter;
+    plan(s, alt, s.queries.front(), cfg, path, counter); // 暖身：工作區長到這張地圖的大小
+    counter.expansions = 0;
+
+    vector<double> lat;
+    lat.reserve(s.queries.size());
+    uint64_t allocs0 = allocCount.load(memory_order_relaxed);
+    auto t0 = steady_clock::now();
+    for (const Query &q : s.queries) {
+        auto q0 = steady_clock::now();
+        if (plan(s, alt, q, cfg, path, counter)) res.found++;
+        lat.push_back(duration_cast<nanoseconds>(steady_clock::now() - q0).count() / 1000.0);
+    }
+    double secs = duration_cast<nanoseconds>(steady_clock::now() - t0).count() / 1e9;
+    uint64_t allocs = allocCount.load(memory_order_relaxed) - allocs0;
+
+    size_t n = s.queries.size();
+    sort(lat.begin(), lat.end());
+    res.qps = secs > 0 ? n / secs : 0.0;
+    res.avgExpansions = (double)counter.expansions / n;
+    res.allocsPerQuery = (double)allocs / n;
+    res.p50 = percentile(lat, 0.50);
+    res.p90 = percentile(lat, 0.90);
+    res.p99 = percentile(lat, 0.99);
+    res.maxUs = lat.back();
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    vector<pair<int, int>> sizes = {{13, 12}, {100, 100}, {500, 500}, {2000, 2000}};
+    vector<double> densities = {0.0, 0.02, 0.1};
+    vector<int> closureCounts = {0, 16, 256};
+    vector<Variant> variants = parseVariants("plain,jps,alt,alt+jps");
+    int queries = 200;
+    unsigned seed = 2025;
+    string csvPath;
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        if (arg == "--sizes" && a + 1 < argc) sizes = parseSizes(argv[++a]);
+        else if (arg == "--density" && a + 1 < argc) densities = parseDoubles(argv[++a]);
+        else if (arg == "--closures" && a + 1 < argc) closureCounts = parseInts(argv[++a]);
+        else if (arg == "--variants" && a + 1 < argc) variants = parseVariants(argv[++a]);
+        else if (arg == "--queries" && a + 1 < argc) queries = atoi(argv[++a]);
+        else if (arg == "--seed" && a + 1 < argc) seed = (unsigned)strtoul(argv[++a], nullptr, 10);
+        else if (arg == "--csv" && a + 1 < argc) csvPath = argv[++a];
+    }
+    if (queries < 1) queries = 1;
+
+    ofstream csvFile;
+    if (!csvPath.empty()) {
+        csvFile.open(csvPath);
+        if (!csvFile) {
+            cerr << "cannot write " << csvPath << "\n";
+            return 1;
+        }
+    }
+    ostream &csv = csvPath.empty() ? cout : csvFile;
+    ostream &table = csvPath.empty() ? cerr : cout; // CSV 寫到 stdout 時，表格改走 stderr
+
+    bool needAlt = false;
+    for (auto &v : variants) needAlt = needAlt || v.alt;
+
+    csv << "rows,cols,density,closures,planner,variant,queries,found,qps,avg_expansions,allocs_per_query,"
+           "p50_us,p90_us,p99_us,max_us\n";
+    char line[256];
+    snprintf(line, sizeof(line), "%11s %7s %8s %-12s %-8s %12s %12s %10s %10s %10s %10s\n", "lot", "density",
+             "closures", "planner", "variant", "queries/s", "expansions", "allocs/q", "p50 us", "p99 us", "max us");
+    table << line;
+    for (auto &sz : sizes) {
+        if (sz.first < 5 || sz.second < 5) {
+            table << sz.first << "x" << sz.second << ": lot too small\n";
+            continue;
+        }
+        for (double d : densities) {
+            for (int cl : closureCounts) {
+                Scenario s = makeScenario(sz.first, sz.second, d, cl, queries, seed);
+                LandmarkHeuristic landmarks; // 與模擬器的 --alt 相同，查詢前建好、不計入時間
+                if (needAlt) {
+                    auto passable = [&s](int r, int c) { return s.grid.passable(PASS_STATIC, r, c); };
+                    landmarks.build(sz.first, sz.second,
+                                    LandmarkHeuristic::pickLandmarks(sz.first, sz.second, passable, {s.entrance}),
+                                    passable);
+                }
+                for (const Variant &v : variants) {
+                    for (int improved = 0; improved < 2; ++improved) {
+                        Result r = run(s, v.alt ? &landmarks : nullptr, improved != 0, v.jps);
+                        const char *name = improved ? "improved" : "traditional";
+                        csv << sz.first << "," << sz.second << "," << d << "," << cl << "," << name << "," << v.name
+                            << "," << queries << "," << r.found << "," << r.qps << "," << r.avgExpansions << ","
+                            << r.allocsPerQuery << "," << r.p50 << "," << r.p90 << "," << r.p99 << "," << r.maxUs
+                            << "\n";
+                        snprintf(line, sizeof(line),
+                                 "%5dx%-5d %7.3f %8d %-12s %-8s %12.0f %12.1f %10.2f %10.1f %10.1f %10.1f\n", sz.first,
+                                 sz.second, d, cl, name, v.name.c_str(), r.qps, r.avgExpansions, r.allocsPerQuery,
+                                 r.p50, r.p99, r.maxUs);
+                        table << line;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
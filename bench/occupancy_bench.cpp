@@ -0,0 +1,174 @@
+// occupancy_bench：格子佔用的壓力測試
+//   V 台車在產生的停車場通道上隨機行走，T 個執行緒分攤車輛、同時推進
+//   比較「全域 mutex + 一般欄位」與 CellOccupancy (每格 atomic word，CAS claim-then-release)
+//   在車輛數增加時的每秒移動次數與佔位衝突率
+//
+// 參數：[--rows R] [--cols C] [--threads T] [--ms 每組毫秒數] [--vehicles 10,100,...]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cell_occupancy.hpp"
+#include "lot_layout.hpp"
+
+using namespace std;
+
+struct Lot {
+    int rows, cols;
+    vector<uint8_t> open; // 通道 = 1
+    vector<int> aisles;   // 所有通道格
+};
+
+static Lot makeLot(int rows, int cols) {
+    LotLayout layout = generateLotLayout(rows, cols);
+    Lot lot{rows, cols, vector<uint8_t>((size_t)rows * cols, 0), {}};
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            LayoutCell t = layout.at(r, c);
+            if (t == LayoutCell::Wall || t == LayoutCell::Stall) continue;
+            lot.open[(size_t)r * cols + c] = 1;
+            lot.aisles.push_back(r * cols + c);
+        }
+    }
+    return lot;
+}
+
+// 隨機挑一個可走的鄰居 (沒有則回傳 -1)
+static int pickNeighbor(const Lot &lot, int cell, mt19937 &eng) {
+    int r = cell / lot.cols, c = cell % lot.cols;
+    int cand[4], n = 0;
+    if (r > 0 && lot.open[cell - lot.cols]) cand[n++] = cell - lot.cols;
+    if (r + 1 < lot.rows && lot.open[cell + lot.cols]) cand[n++] = cell + lot.cols;
+    if (c > 0 && lot.open[cell - 1]) cand[n++] = cell - 1;
+    if (c + 1 < lot.cols && lot.open[cell + 1]) cand[n++] = cell + 1;
+    return n ? cand[eng() % n] : -1;
+}
+
+struct Result {
+    double movesPerSec;
+    double conflictPct;
+};
+
+// 全域鎖：與原本 moveVehicle 相同，檢查 + 寫入都在同一把 mutex 內
+static Result runMutex(const Lot &lot, int vehicles, int threads, int ms) {
+    vector<char> occupied(lot.open.size(), 0);
+    vector<int> pos(vehicles);
+    for (int v = 0; v < vehicles; ++v) {
+        pos[v] = lot.aisles[(size_t)v * lot.aisles.size() / vehicles];
+        occupied[pos[v]] = 1;
+    }
+    mutex m;
+    atomic<bool> stop{false};
+    atomic<uint64_t> moves{0}, conflicts{0};
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            mt19937 eng(1234 + t);
+            uint64_t myMoves = 0, myConflicts = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                for (int v = t; v < vehicles; v += threads) {
+                    int next = pickNeighbor(lot, pos[v], eng);
+                    if (next < 0) continue;
+                    lock_guard<mutex> lk(m);
+                    if (occupied[next]) {
+                        ++myConflicts;
+                        continue;
+                    }
+                    occupied[next] = 1;
+                    occupied[pos[v]] = 0;
+                    pos[v] = next;
+                    ++myMoves;
+                }
+            }
+            moves += myMoves;
+            conflicts += myConflicts;
+        });
+    }
+    this_thread::sleep_for(chrono::milliseconds(ms));
+    stop = true;
+    for (auto &th : pool) th.join();
+    uint64_t tries = moves + conflicts;
+    return Result{moves * 1000.0 / ms, tries ? 100.0 * conflicts / tries : 0.0};
+}
+
+// CellOccupancy：每一步只有兩次 CAS，不同車輛之間沒有共用的鎖
+static Result runCas(const Lot &lot, int vehicles, int threads, int ms) {
+    CellOccupancy occ;
+    occ.reset(lot.open.size());
+    vector<int> pos(vehicles);
+    for (int v = 0; v < vehicles; ++v) {
+        pos[v] = lot.aisles[(size_t)v * lot.aisles.size() / vehicles];
+        occ.tryClaim(pos[v], v + 1, CellOccupancy::DRIVING);
+    }
+    atomic<bool> stop{false};
+    atomic<uint64_t> moves{0};
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            mt19937 eng(1234 + t);
+            uint64_t myMoves = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                for (int v = t; v < vehicles; v += threads) {
+                    int next = pickNeighbor(lot, pos[v], eng);
+                    if (next < 0) continue;
+                    if (occ.tryMove(pos[v], next, v + 1, CellOccupancy::DRIVING)) {
+                        pos[v] = next;
+                        ++myMoves;
+                    }
+                }
+            }
+            moves += myMoves;
+        });
+    }
+    this_thread::sleep_for(chrono::milliseconds(ms));
+    stop = true;
+    for (auto &th : pool) th.join();
+    uint64_t conflicts = occ.failedClaimCount();
+    uint64_t tries = moves + conflicts;
+    return Result{moves * 1000.0 / ms, tries ? 100.0 * conflicts / tries : 0.0};
+}
+
+int main(int argc, char *argv[]) {
+    int rows = 200, cols = 200, ms = 300;
+    int threads = (int)thread::hardware_concurrency();
+    vector<int> counts = {10, 50, 100, 500, 1000, 5000};
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        if (arg == "--rows" && a + 1 < argc) rows = atoi(argv[++a]);
+        else if (arg == "--cols" && a + 1 < argc) cols = atoi(argv[++a]);
+        else if (arg == "--threads" && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (arg == "--ms" && a + 1 < argc) ms = atoi(argv[++a]);
+        else if (arg == "--vehicles" && a + 1 < argc) {
+            counts.clear();
+            stringstream ss(argv[++a]);
+            string item;
+            while (getline(ss, item, ',')) counts.push_back(atoi(item.c_str()));
+        }
+    }
+    if (threads < 1) threads = 1;
+
+    Lot lot = makeLot(rows, cols);
+    cout << "lot " << rows << "x" << cols << ", " << lot.aisles.size() << " aisle cells, " << threads
+         << " thread(s), " << ms << " ms per point\n";
+    printf("%9s %16s %10s %16s %10s %8s\n", "vehicles", "mutex moves/s", "conflict%", "cas moves/s", "conflict%",
+           "speedup");
+    for (int v : counts) {
+        if (v > (int)lot.aisles.size()) {
+            cout << v << " vehicles do not fit\n";
+            continue;
+        }
+        Result a = runMutex(lot, v, threads, ms);
+        Result b = runCas(lot, v, threads, ms);
+        printf("%9d %16.0f %9.1f%% %16.0f %9.1f%% %7.2fx\n", v, a.movesPerSec, a.conflictPct, b.movesPerSec,
+               b.conflictPct, a.movesPerSec > 0 ? b.movesPerSec / a.movesPerSec : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// --------------------------------------------------------------------
+// CellOccupancy：每格一個 32-bit atomic word = (owner << 8) | state
+//   owner 0 表示空格；車輛前進一格 = tryMove()：先以 CAS 佔下一格 (FREE -> 自己)，
+//   成功後再以 CAS 釋放原本的格子 (只有自己是 owner 時才清掉)
+//   不需要全域 mutex，佔位衝突時 CAS 失敗、車輛原地等待
+// --------------------------------------------------------------------
+class CellOccupancy {
+public:
+    enum State : uint32_t { FREE = 0, DRIVING = 1, PARKING = 2 };
+
+    static constexpr uint32_t MAX_OWNER = (1u << 24) - 1;
+
+    static uint32_t pack(uint32_t owner, State s) { return (owner << 8) | (uint32_t)s; }
+    static uint32_t ownerOf(uint32_t word) { return word >> 8; }
+    static State stateOf(uint32_t word) { return (State)(word & 0xffu); }
+
+    CellOccupancy() = default;
+    CellOccupancy(const CellOccupancy &) = delete;
+    CellOccupancy &operator=(const CellOccupancy &) = delete;
+
+    // 全部清成空格 (不可與其他執行緒的 claim 同時呼叫)
+    void reset(size_t cells) {
+        if (cells != n) {
+            words.reset(new std::atomic<uint32_t>[cells]);
+            n = cells;
+        }
+        for (size_t i = 0; i < n; ++i) words[i].store(0, std::memory_order_relaxed);
+        failedClaims.store(0, std::memory_order_relaxed);
+    }
+
+    size_t size() const { return n; }
+
+    uint32_t load(size_t i) const { return words[i].load(std::memory_order_acquire); }
+    bool isFree(size_t i) const { return load(i) == 0; }
+    uint32_t owner(size_t i) const { return ownerOf(load(i)); }
+
+    // 空格才佔得到
+    bool tryClaim(size_t i, uint32_t owner, State s) {
+        uint32_t expected = 0;
+        if (words[i].compare_exchange_strong(expected, pack(owner, s), std::memory_order_acq_rel,
+                                             std::memory_order_acquire))
+            return true;
+        failedClaims.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 只有 owner 本人可以釋放；被別人佔走 (見 place) 時回傳 false、不動
+    bool release(size_t i, uint32_t owner) {
+        uint32_t cur = words[i].load(std::memory_order_acquire);
+        while (ownerOf(cur) == owner) {
+            if (words[i].compare_exchange_weak(cur, 0, std::memory_order_acq_rel, std::memory_order_acquire))
+                return true;
+        }
+        return false;
+    }
+
+    // owner 不變，只改 state (例如 DRIVING -> PARKING)
+    bool setState(size_t i, uint32_t owner, State s) {
+        uint32_t cur = words[i].load(std::memory_order_acquire);
+        while (ownerOf(cur) == owner) {
+            if (words[i].compare_exchange_weak(cur, pack(owner, s), std::memory_order_acq_rel,
+                                               std::memory_order_acquire))
+                return true;
+        }
+        return false;
+    }
+
+    // claim-then-release：佔到 to 才放掉 from
+    bool tryMove(size_t from, size_t to, uint32_t owner, State s) {
+        if (!tryClaim(to, owner, s)) return false;
+        release(from, owner);
+        return true;
+    }
+
+    // 不檢查直接佔位 (進場時入口可以與前一台尚未開走的車重疊，沿用原本的行為)
+    void place(size_t i, uint32_t owner, State s) { words[i].store(pack(owner, s), std::memory_order_release); }
+
+    uint64_t failedClaimCount() const { return failedClaims.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<std::atomic<uint32_t>[]> words;
+    size_t n = 0;
+    std::atomic<uint64_t> failedClaims{0};
+};
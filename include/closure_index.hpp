@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// --------------------------------------------------------------------
+// ClosureMap：任意數量的封閉格，以 bitmap 存放 (每格 1 bit)
+// --------------------------------------------------------------------
+class ClosureMap {
+public:
+    void reset(int rows, int cols) {
+        nCols = cols;
+        bits.assign(((size_t)rows * cols + 63) / 64, 0);
+        closedCount = 0;
+    }
+
+    int index(int r, int c) const { return r * nCols + c; }
+
+    bool isClosed(int r, int c) const {
+        size_t i = (size_t)index(r, c);
+        return (bits[i >> 6] >> (i & 63)) & 1u;
+    }
+
+    // 回傳 true => 狀態真的有改變
+    bool close(int r, int c) { return set(r, c, true); }
+    bool reopen(int r, int c) { return set(r, c, false); }
+
+    size_t count() const { return closedCount; }
+
+private:
+    bool set(int r, int c, bool closed) {
+        size_t i = (size_t)index(r, c);
+        uint64_t mask = uint64_t(1) << (i & 63);
+        if (((bits[i >> 6] & mask) != 0) == closed) return false;
+        bits[i >> 6] ^= mask;
+        closedCount += closed ? 1 : (size_t)-1;
+        return true;
+    }
+
+    int nCols = 0;
+    std::vector<uint64_t> bits;
+    size_t closedCount = 0;
+};
+
+// --------------------------------------------------------------------
+// RouteIndex：格子 -> 目前路線還會經過這格的車輛 (反向索引)
+//   assign() 登記整條剩餘路線，leave() 在車輛離開一格時移除，remove() 清掉整台車
+//   封閉一格時 vehiclesOn() 直接取得受影響的車，不必掃每台車的路徑
+// --------------------------------------------------------------------
+class RouteIndex {
+public:
+    void reset(int rows, int cols) {
+        nCols = cols;
+        byCell.assign((size_t)rows * cols, {});
+        routes.clear();
+    }
+
+    template <class Path>
+    void assign(int vehicle, const Path &path) {
+        remove(vehicle);
+        std::vector<int> &cells = routes[vehicle];
+        cells.reserve(path.size());
+        for (auto &p : path) {
+            int idx = p.first * nCols + p.second;
+            std::vector<int> &owners = byCell[idx];
+            if (std::find(owners.begin(), owners.end(), vehicle) != owners.end()) continue;
+            owners.push_back(vehicle);
+            cells.push_back(idx);
+        }
+    }
+
+    void leave(int vehicle, int r, int c) { eraseOwner(r * nCols + c, vehicle); }
+
+    void remove(int vehicle) {
+        auto it = routes.find(vehicle);
+        if (it == routes.end()) return;
+        for (int idx : it->second) eraseOwner(idx, vehicle);
+        routes.erase(it);
+    }
+
+    const std::vector<int> &vehiclesOn(int r, int c) const { return byCell[(size_t)r * nCols + c]; }
+
+private:
+    void eraseOwner(int idx, int vehicle) {
+        std::vector<int> &owners = byCell[idx];
+        auto it = std::find(owners.begin(), owners.end(), vehicle);
+        if (it == owners.end()) return;
+        *it = owners.back();
+        owners.pop_back();
+    }
+
+    int nCols = 0;
+    std::vector<std::vector<int>> byCell;
+    std::unordered_map<int, std::vector<int>> routes; // 每台車登記過的格子 (remove 用)
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// DStarLite：每台車一份的增量式規劃 (D* Lite, Koenig & Likhachev 2002)
+//   由終點往回搜尋，g / rhs 保留在車上；車往前走只需調整 km
+//   格子封閉或重新開放時只把該格與鄰居重新放回 open list，
+//   下一次 computeShortestPath() 只修補受影響的部分，而不是整張地圖重搜
+//   邊的成本固定為 1 (4 連通)，blocked 平面由呼叫端維護並通知 cellChanged()
+//   start 是車輛目前所在的格子，即使剛被封閉也可以離開 (與 A* 從起點出發相同)
+// --------------------------------------------------------------------
+class DStarLite {
+public:
+    static constexpr int INF = INT_MAX / 2;
+
+    DStarLite(int rows, int cols, const std::vector<uint8_t> *blocked, int goalRow, int goalCol)
+        : nRows(rows), nCols(cols), blocked(blocked),
+          g((size_t)rows * cols, INF), rhs((size_t)rows * cols, INF),
+          queuedKey((size_t)rows * cols), inOpen((size_t)rows * cols, 0) {
+        goal = index(goalRow, goalCol);
+        start = last = goal;
+        rhs[goal] = 0;
+        push(goal, calcKey(goal));
+    }
+
+    int goalRow() const { return goal / nCols; }
+    int goalCol() const { return goal % nCols; }
+
+    // 車輛目前位置 (第一次呼叫前 start 等於 goal)
+    void setStart(int r, int c) {
+        int s = index(r, c);
+        if (s == start) return;
+        int prev = start;
+        km += manhattan(last, s);
+        last = start = s;
+        // 被封閉的格子只有身為 start 時可離開：新舊 start 的 rhs 都要重算
+        if ((*blocked)[prev]) updateVertex(prev);
+        if ((*blocked)[s]) updateVertex(s);
+    }
+
+    // (r, c) 的 blocked 狀態改變：這格與四個鄰居的 rhs 需要重新計算
+    void cellChanged(int r, int c) {
+        int u = index(r, c);
+        updateVertex(u);
+        forEachNeighbor(u, [&](int nb) { updateVertex(nb); });
+    }
+
+    // 修補到 start 的最短距離一致為止；回傳是否有路
+    bool computeShortestPath() {
+        lastExpanded = 0;
+        Entry top;
+        while (peek(top)) {
+            if (!(top.key < calcKey(start)) && rhs[start] == g[start]) break;
+            popTop();
+            int u = top.node;
+            inOpen[u] = 0;
+            ++lastExpanded;
+            Key fresh = calcKey(u);
+            if (top.key < fresh) {
+                push(u, fresh);
+            } else if (g[u] > rhs[u]) {
+                g[u] = rhs[u];
+                forEachNeighbor(u, [&](int nb) { updateVertex(nb); });
+            } else {
+                g[u] = INF;
+                updateVertex(u);
+                forEachNeighbor(u, [&](int nb) { updateVertex(nb); });
+            }
+        }
+        totalExpanded += lastExpanded;
+        return g[start] < INF;
+    }
+
+    // 從 start 沿 g 遞減走到 goal (含兩端)
+    bool extractPath(std::vector<std::pair<int, int>> &out) const {
+        out.clear();
+        if (g[start] >= INF) return false;
+        int cur = start;
+        out.emplace_back(cur / nCols, cur % nCols);
+        for (size_t steps = 0; cur != goal; ++steps) {
+            if (steps > g.size()) return false;
+            int best = -1, bestG = INF;
+            forEachNeighbor(cur, [&](int nb) {
+                if (!(*blocked)[nb] && g[nb] < bestG) {
+                    bestG = g[nb];
+                    best = nb;
+                }
+            });
+            if (best < 0) return false;
+            cur = best;
+            out.emplace_back(cur / nCols, cur % nCols);
+        }
+        return true;
+    }
+
+    uint64_t lastExpansions() const { return lastExpanded; }
+    uint64_t totalExpansions() const { return totalExpanded; }
+
+private:
+    struct Key {
+        int k1, k2;
+        bool operator<(const Key &o) const { return k1 != o.k1 ? k1 < o.k1 : k2 < o.k2; }
+        bool operator==(const Key &o) const { return k1 == o.k1 && k2 == o.k2; }
+    };
+    struct Entry {
+        Key key;
+        int node;
+    };
+    struct EntryGreater {
+        bool operator()(const Entry &a, const Entry &b) const { return b.key < a.key; }
+    };
+
+    int index(int r, int c) const { return r * nCols + c; }
+    int manhattan(int a, int b) const { return std::abs(a / nCols - b / nCols) + std::abs(a % nCols - b % nCols); }
+
+    template <class F>
+    void forEachNeighbor(int u, F f) const {
+        int r = u / nCols, c = u % nCols;
+        if (r > 0) f(u - nCols);
+        if (r + 1 < nRows) f(u + nCols);
+        if (c > 0) f(u - 1);
+        if (c + 1 < nCols) f(u + 1);
+    }
+
+    Key calcKey(int u) const {
+        int m = std::min(g[u], rhs[u]);
+        if (m >= INF) return Key{INF, INF};
+        return Key{m + manhattan(start, u) + km, m};
+    }
+
+    int minSuccessor(int u) const {
+        if ((*blocked)[u] && u != start) return INF;
+        int best = INF;
+        forEachNeighbor(u, [&](int nb) {
+            if (!(*blocked)[nb] && g[nb] < INF) best = std::min(best, g[nb] + 1);
+        });
+        return best;
+    }
+
+    void updateVertex(int u) {
+        if (u != goal) rhs[u] = minSuccessor(u);
+        if (g[u] != rhs[u])
+            push(u, calcKey(u));
+        else
+            inOpen[u] = 0; // 舊的 heap 項目 pop 時略過
+    }
+
+    // heap 採 lazy deletion：每格只認最後一次 push 的 key
+    void push(int u, Key k) {
+        inOpen[u] = 1;
+        queuedKey[u] = k;
+        open.push_back(Entry{k, u});
+        std::push_heap(open.begin(), open.end(), EntryGreater());
+    }
+    bool peek(Entry &top) {
+        while (!open.empty()) {
+            const Entry &e = open.front();
+            if (inOpen[e.node] && queuedKey[e.node] == e.key) {
+                top = e;
+                return true;
+            }
+            popTop();
+        }
+        return false;
+    }
+    void popTop() {
+        std::pop_heap(open.begin(), open.end(), EntryGreater());
+        open.pop_back();
+    }
+
+    int nRows, nCols;
+    const std::vector<uint8_t> *blocked;
+    std::vector<int> g, rhs;
+    std::vector<Key> queuedKey;
+    std::vector<uint8_t> inOpen;
+    std::vector<Entry> open;
+    int start, last, goal;
+    int km = 0;
+    uint64_t lastExpanded = 0, totalExpanded = 0;
+};
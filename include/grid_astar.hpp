@@ -0,0 +1,145 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "lot_grid.hpp"
+#include "search_context.hpp"
+
+// --------------------------------------------------------------------
+// GridAStar：兩個模擬器 (250604statisticlog 的 aStar、250919repath 的 aStarWithReturn)
+//   與 astar_bench 共用的 A* 核心
+//   4 連通，可通行 = LotGrid pass class 的 neighborMask，每步成本 1
+//   improved (改良 A*)：走進一格時再加 max(waitTime - g, 0)
+//   jps：沿沒有岔路的直線通道一次跳到下一個決策點 (4 連通的 jump point search)
+//   heuristic 與「需要逐格展開的格子」由呼叫端提供；其餘由 hooks 處理：
+//   呼叫端額外不走的鄰居 (skip)，以及搜尋過程的回報 (路線快取讀過的格子、SEARCH_STATS 計數)，
+//   不需要的部分沿用 SearchHooks 的空實作
+// --------------------------------------------------------------------
+struct GridAStarConfig {
+    int passClass = 0;
+    bool improved = false;
+    bool jps = false;
+};
+
+struct SearchHooks {
+    bool skip(int, int) { return false; } // 可通行但這次搜尋不走的格子
+    void visit(int, int) {}   // 搜尋讀過的格子 (展開或 jump 經過)
+    void push() {}
+    void stalePop() {}        // 從 open list 取出但已 closed 的重複項目
+    void penalty(int) {}      // 這次 push 加上的 waitTime 懲罰
+    void searched(const SearchContext &) {} // ctx.finish() 之前呼叫一次
+};
+
+namespace grid_astar_detail {
+
+static const int DR[4] = {-1, 1, 0, 0};
+static const int DC[4] = {0, 0, -1, 1};
+
+// 從 (r,c) 往方向 dir 直走，停在下一個決策點，回傳走了幾格 (至少 1)
+//   決策點 = 終點、左右有岔路、前方不通，或需要逐格展開的格子
+//   (改良組有 waitTime 懲罰的格子，以及呼叫端的 plainCell)
+//   跳過的格子只有前後兩個方向、成本固定為 1，逐格展開也只會走同一條路，
+//   所以路徑成本與一般 A* 相同；停下來的格子照常計算 waitTime 懲罰
+//   但放進 open list 的節點不同，f 相同時 heap 挑中的路線可能不同
+template <class PlainCell, class Hooks>
+int jump(const LotGrid &grid, const GridAStarConfig &cfg, int &r, int &c, int dir, int er, int ec,
+         PlainCell &plainCell, Hooks &hooks) {
+    const uint32_t sides = dir < 2 ? (LotGrid::LEFT | LotGrid::RIGHT) : (LotGrid::UP | LotGrid::DOWN);
+    int steps = 1;
+    hooks.visit(r, c);
+    while (!(r == er && c == ec) && !(cfg.improved && grid.waitTime(r, c) > 0) && !plainCell(r, c)) {
+        uint32_t m = grid.neighborMask(cfg.passClass, r, c);
+        if ((m & sides) || !(m & (1u << dir)) || hooks.skip(r + DR[dir], c + DC[dir])) break;
+        r += DR[dir];
+        c += DC[dir];
+        steps++;
+        hooks.visit(r, c);
+    }
+    return steps;
+}
+
+// jump point 之間補回中間的格子 (同一列或同一行)
+inline void fillJumps(std::vector<std::pair<int, int>> &path) {
+    std::vector<std::pair<int, int>> full;
+    full.reserve(path.size());
+    for (size_t k = 0; k < path.size(); k++) {
+        if (k > 0) {
+            std::pair<int, int> p = path[k - 1];
+            int dr = (path[k].first > p.first) - (path[k].first < p.first);
+            int dc = (path[k].second > p.second) - (path[k].second < p.second);
+            for (p.first += dr, p.second += dc; p != path[k]; p.first += dr, p.second += dc) full.push_back(p);
+        }
+        full.push_back(path[k]);
+    }
+    path.swap(full);
+}
+
+} // namespace grid_astar_detail
+
+// (sr,sc) -> (er,ec)；找到時 path 為逐格的完整路線、goalG 為終點的 g，回傳 true
+//   heuristic(r, c, er, ec)、plainCell(r, c)：JPS 必須停下逐格展開的格子 (例如行駛中的車輛)
+//   節點與 open list 使用呼叫執行緒的 SearchContext
+template <class Heuristic, class PlainCell, class Hooks>
+bool gridAStar(const LotGrid &grid, const GridAStarConfig &cfg, int sr, int sc, int er, int ec,
+               Heuristic heuristic, PlainCell plainCell, Hooks &hooks, std::vector<std::pair<int, int>> &path,
+               int *goalG = nullptr) {
+    using namespace grid_astar_detail;
+    SearchContext &ctx = SearchContext::local();
+    NodePool &pool = ctx.pool;
+    ctx.begin(grid.rows(), grid.cols());
+
+    ctx.setCost(ctx.index(sr, sc), 0);
+    int startIdx = pool.add(sr, sc, 0, heuristic(sr, sc, er, ec), -1);
+    ctx.pushOpen(OpenEntry{pool[startIdx].f(), startIdx});
+    hooks.push();
+
+    while (!ctx.openEmpty()) {
+        int curIdx = ctx.popOpen().node;
+        SearchNode cur = pool[curIdx];
+        int curCell = ctx.index(cur.row, cur.col);
+        if (ctx.isClosed(curCell)) {
+            hooks.stalePop(); // 已用較小 g 展開過
+            continue;
+        }
+        ctx.close(curCell);
+        hooks.visit(cur.row, cur.col);
+
+        if (cur.row == er && cur.col == ec) {
+            pool.buildPath(curIdx, path);
+            if (cfg.jps) fillJumps(path);
+            if (goalG) *goalG = cur.g;
+            hooks.searched(ctx);
+            ctx.finish();
+            return true;
+        }
+
+        uint32_t open = grid.neighborMask(cfg.passClass, cur.row, cur.col);
+        for (int i = 0; i < 4; i++) {
+            if (!(open & (1u << i))) continue;
+            int nr = cur.row + DR[i];
+            int nc = cur.col + DC[i];
+            if (hooks.skip(nr, nc)) continue;
+            int steps = cfg.jps ? jump(grid, cfg, nr, nc, i, er, ec, plainCell, hooks) : 1;
+            int baseG = cur.g + steps;
+            int extra = 0;
+            if (cfg.improved) {
+                int remain = grid.waitTime(nr, nc) - baseG;
+                if (remain > 0) extra = remain;
+            }
+            int newG = baseG + extra;
+
+            int nCell = ctx.index(nr, nc);
+            if (newG < ctx.cost(nCell)) {
+                ctx.setCost(nCell, newG);
+                int nxt = pool.add(nr, nc, newG, heuristic(nr, nc, er, ec), curIdx);
+                ctx.pushOpen(OpenEntry{pool[nxt].f(), nxt});
+                hooks.push();
+                hooks.penalty(extra);
+            }
+        }
+    }
+    hooks.searched(ctx);
+    ctx.finish();
+    return false;
+}
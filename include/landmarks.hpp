@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// LandmarkHeuristic：ALT (A*, Landmarks, Triangle inequality)
+//   對幾個 landmark (入口、出口、四個角落) 在靜態地圖上做 BFS，得到精確距離表
+//   h(n) = max(Manhattan, max_L |d(L, goal) - d(L, n)|)
+//   只要實際可走的格子是靜態地圖的子集、每步成本 >= 1，h 就是 admissible 且 consistent
+//   有格子封閉 / 重新開放時，只重算受影響的距離表
+// --------------------------------------------------------------------
+class LandmarkHeuristic {
+public:
+    static constexpr int UNREACHABLE = INT_MAX;
+
+    // passable(r, c)：靜態可通行 (不含車輛等動態狀態)
+    template <class Passable>
+    void build(int rows, int cols, const std::vector<std::pair<int, int>> &landmarks, Passable passable) {
+        nRows = rows;
+        nCols = cols;
+        open.assign((size_t)rows * cols, 0);
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c) open[index(r, c)] = passable(r, c) ? 1 : 0;
+        marks = landmarks;
+        dist.assign(marks.size() * open.size(), UNREACHABLE);
+        for (size_t l = 0; l < marks.size(); ++l) rebuildField(l);
+        rebuilds = 0;
+    }
+
+    // 入口等指定的 landmark + 離四個角落最近的可通行格 (重複的只留一個)
+    template <class Passable>
+    static std::vector<std::pair<int, int>> pickLandmarks(int rows, int cols, Passable passable,
+                                                          std::vector<std::pair<int, int>> fixed) {
+        const std::pair<int, int> corners[4] = {{0, 0}, {0, cols - 1}, {rows - 1, 0}, {rows - 1, cols - 1}};
+        for (auto corner : corners) {
+            std::pair<int, int> best{-1, -1};
+            int bestD = INT_MAX;
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    int d = std::abs(r - corner.first) + std::abs(c - corner.second);
+                    if (d < bestD && passable(r, c)) {
+                        bestD = d;
+                        best = {r, c};
+                    }
+                }
+            }
+            if (best.first >= 0 && std::find(fixed.begin(), fixed.end(), best) == fixed.end())
+                fixed.push_back(best);
+        }
+        return fixed;
+    }
+
+    int estimate(int r, int c, int goalR, int goalC) const {
+        int h = std::abs(goalR - r) + std::abs(goalC - c);
+        size_t n = index(r, c), g = index(goalR, goalC);
+        for (size_t l = 0; l < marks.size(); ++l) {
+            int dn = dist[l * open.size() + n];
+            int dg = dist[l * open.size() + g];
+            if (dn == UNREACHABLE || dg == UNREACHABLE) continue;
+            h = std::max(h, std::abs(dg - dn));
+        }
+        return h;
+    }
+
+    // 格子變成不可通行 (CLOSED_AISLE) 或重新開放時呼叫
+    //   封閉：只有以這格為前一步 (鄰居距離 = 本格 + 1) 的距離表需要重算
+    //   開放：只要有鄰居可達，這格就可能變成捷徑，該表重算
+    void setPassable(int r, int c, bool passable) {
+        size_t idx = index(r, c);
+        if ((open[idx] != 0) == passable) return;
+        open[idx] = passable ? 1 : 0;
+        for (size_t l = 0; l < marks.size(); ++l) {
+            const int *d = &dist[l * open.size()];
+            bool affected = false;
+            forEachNeighbor(r, c, [&](size_t nb) {
+                if (passable)
+                    affected = affected || d[nb] != UNREACHABLE;
+                else
+                    affected = affected || (d[idx] != UNREACHABLE && d[nb] == d[idx] + 1);
+            });
+            if (affected) rebuildField(l);
+        }
+    }
+
+    size_t landmarkCount() const { return marks.size(); }
+    uint64_t fieldRebuilds() const { return rebuilds; } // build() 之後因封閉 / 開放而重算的次數
+
+private:
+    size_t index(int r, int c) const { return (size_t)r * nCols + c; }
+
+    template <class F>
+    void forEachNeighbor(int r, int c, F f) const {
+        if (r > 0) f(index(r - 1, c));
+        if (r + 1 < nRows) f(index(r + 1, c));
+        if (c > 0) f(index(r, c - 1));
+        if (c + 1 < nCols) f(index(r, c + 1));
+    }
+
+    // BFS (每步成本 1)；landmark 本身即使被封閉也當作起點
+    void rebuildField(size_t l) {
+        int *d = &dist[l * open.size()];
+        std::fill(d, d + open.size(), UNREACHABLE);
+        std::deque<size_t> q;
+        size_t src = index(marks[l].first, marks[l].second);
+        d[src] = 0;
+        q.push_back(src);
+        while (!q.empty()) {
+            size_t cur = q.front();
+            q.pop_front();
+            forEachNeighbor((int)(cur / nCols), (int)(cur % nCols), [&](size_t nb) {
+                if (open[nb] && d[nb] == UNREACHABLE) {
+                    d[nb] = d[cur] + 1;
+                    q.push_back(nb);
+                }
+            });
+        }
+        ++rebuilds;
+    }
+
+    int nRows = 0, nCols = 0;
+    std::vector<uint8_t> open;
+    std::vector<std::pair<int, int>> marks;
+    std::vector<int> dist; // dist[l * cells + idx]
+    uint64_t rebuilds = 0;
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "vehicle_table.hpp"
+
+// --------------------------------------------------------------------
+// LotGrid：停車場狀態以 structure-of-arrays 存放 (一維、row-major)
+//   type 平面 (每格 1 byte)、waitTime 平面、佔用平面 (32-bit VehicleId / 終點認領者，0 = 沒有車)
+//   isMoving 與各種「可通行」規則則是 bitboard (每格 1 bit)
+//
+// 可通行規則 (pass class)：rule[type] = PASS_NEVER / PASS_ALWAYS / PASS_IF_MOVING
+//   setType / setMoving 時順手更新每個規則的 bitboard，規劃時只需測 bit
+//   bitboard 四周多留一圈永遠不可通行的格子，鄰居測試不必檢查邊界
+//
+// 區塊戳記：地圖切成 TILE×TILE 的區塊，規劃器讀得到的內容改變時，該區塊換一個新的戳記
+//   (全程式唯一，不同地圖、複本之間不會重複)；戳記相同 => 規劃器看到的內容相同，
+//   RouteCache 以此判斷快取的路線是否仍然有效
+//   「讀得到的內容」= 追蹤中的 pass class 的 bit、waitTime、在追蹤中的 class 可通行之格子的 type
+//   (預設追蹤全部 class；setStampClasses 可只留規劃器實際使用的)
+//
+// 變更記錄：setChangeLog 之後，type / waitTime 有改變的格子編號會 append 到指定的 vector
+//   (TraceWriter 每個 tick 只看這些格子)；沒設定時只多一個判斷
+// --------------------------------------------------------------------
+class LotGrid {
+public:
+    static constexpr int MAX_TYPES = 8;
+    static constexpr int MAX_PASS_CLASSES = 4;
+
+    enum PassMode : uint8_t { PASS_NEVER = 0, PASS_ALWAYS = 1, PASS_IF_MOVING = 2 };
+    using PassRule = std::array<uint8_t, MAX_TYPES>;
+
+    // 鄰居遮罩的 bit：與各規劃器的方向順序相同 (上、下、左、右)
+    enum Neighbor : uint32_t { UP = 1, DOWN = 2, LEFT = 4, RIGHT = 8 };
+
+    static constexpr int TILE_SHIFT = 3; // 8×8 區塊
+    static constexpr int TILE = 1 << TILE_SHIFT;
+
+    void reset(int rows, int cols, uint8_t fillType, bool fillMoving = false) {
+        nRows = rows;
+        nCols = cols;
+        stride = ((size_t)cols + 2 + 63) / 64;
+        size_t cells = (size_t)rows * cols;
+        typePlane.assign(cells, fillType);
+        waitPlane.assign(cells, 0);
+        occupantPlane.assign(cells, NO_VEHICLE);
+        claimPlane.assign(cells, NO_VEHICLE);
+        movingBits.assign(stride * (rows + 2), 0);
+        for (int r = 0; r < rows && fillMoving; ++r)
+            for (int c = 0; c < cols; ++c) assignBit(movingBits, r + 1, c + 1, true);
+        for (int k = 0; k < nClasses; ++k) rebuildClass(k);
+        tileCols = (cols + TILE - 1) >> TILE_SHIFT;
+        tileStamps.resize((size_t)((rows + TILE - 1) >> TILE_SHIFT) * tileCols);
+        for (uint64_t &s : tileStamps) s = nextStamp();
+    }
+
+    void setChangeLog(std::vector<int> *log) { changeLog = log; }
+
+    // 哪些 pass class 會影響區塊戳記 (bit k = class k)
+    void setStampClasses(uint32_t mask) { stampClasses = mask; }
+
+    // 新增一個可通行規則，回傳編號 (依目前內容建立 bitboard)
+    int definePassClass(const PassRule &rule) {
+        int k = nClasses++;
+        rules[k] = rule;
+        rebuildClass(k);
+        return k;
+    }
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    int index(int r, int c) const { return r * nCols + c; }
+
+    uint8_t type(int r, int c) const { return typePlane[index(r, c)]; }
+    void setType(int r, int c, uint8_t t) {
+        if (typePlane[index(r, c)] == t) return;
+        uint32_t before = stampedBits(r, c);
+        typePlane[index(r, c)] = t;
+        if (changeLog) changeLog->push_back(index(r, c));
+        refreshBits(r, c);
+        if (before | stampedBits(r, c)) touch(r, c);
+    }
+
+    int waitTime(int r, int c) const { return waitPlane[index(r, c)]; }
+    void setWaitTime(int r, int c, int w) {
+        if (waitPlane[index(r, c)] == w) return;
+        waitPlane[index(r, c)] = w;
+        if (changeLog) changeLog->push_back(index(r, c));
+        touch(r, c);
+    }
+
+    VehicleId occupant(int r, int c) const { return occupantPlane[index(r, c)]; }
+    void setOccupant(int r, int c, VehicleId v) { occupantPlane[index(r, c)] = v; }
+
+    // 終點的認領者 (statisticlog 的 occupiedBy)
+    VehicleId claim(int r, int c) const { return claimPlane[index(r, c)]; }
+    void setClaim(int r, int c, VehicleId v) { claimPlane[index(r, c)] = v; }
+
+    bool moving(int r, int c) const { return testBit(movingBits, r + 1, c + 1); }
+    void setMoving(int r, int c, bool m) {
+        if (moving(r, c) == m) return;
+        uint32_t before = stampedBits(r, c);
+        assignBit(movingBits, r + 1, c + 1, m);
+        refreshBits(r, c);
+        if (before != stampedBits(r, c)) touch(r, c);
+    }
+
+    // 超出地圖一律不可通行
+    bool passable(int cls, int r, int c) const {
+        if (r < -1 || r > nRows || c < -1 || c > nCols) return false;
+        return testBit(passBits[cls], r + 1, c + 1);
+    }
+
+    // (r, c) 四個鄰居中可通行者的遮罩 (UP | DOWN | LEFT | RIGHT)；(r, c) 必須在地圖內
+    uint32_t neighborMask(int cls, int r, int c) const {
+        const std::vector<uint64_t> &b = passBits[cls];
+        int pc = c + 1;
+        size_t w = (size_t)pc >> 6;
+        unsigned s = (unsigned)pc & 63;
+        uint32_t m = (uint32_t)((b[(size_t)r * stride + w] >> s) & 1u);           // 上
+        m |= (uint32_t)((b[(size_t)(r + 2) * stride + w] >> s) & 1u) << 1;        // 下
+        const uint64_t *row = &b[(size_t)(r + 1) * stride];
+        m |= (uint32_t)((row[(size_t)(pc - 1) >> 6] >> ((pc - 1) & 63)) & 1u) << 2; // 左
+        m |= (uint32_t)((row[(size_t)(pc + 1) >> 6] >> ((pc + 1) & 63)) & 1u) << 3; // 右
+        return m;
+    }
+
+    // 區塊戳記
+    int tileCount() const { return (int)tileStamps.size(); }
+    int tileIndex(int r, int c) const { return (r >> TILE_SHIFT) * tileCols + (c >> TILE_SHIFT); }
+    uint64_t tileStamp(int tile) const { return tileStamps[tile]; }
+
+    // 找出所有指定 type 的格子
+    template <class F>
+    void forEachOfType(uint8_t t, F f) const {
+        for (int r = 0; r < nRows; ++r)
+            for (int c = 0; c < nCols; ++c)
+                if (typePlane[index(r, c)] == t) f(r, c);
+    }
+
+private:
+    static uint64_t nextStamp() {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    void touch(int r, int c) { tileStamps[tileIndex(r, c)] = nextStamp(); }
+
+    // 追蹤中的 class 在 (r, c) 的可通行 bit
+    uint32_t stampedBits(int r, int c) const {
+        uint32_t m = 0;
+        for (int k = 0; k < nClasses; ++k)
+            if ((stampClasses >> k) & 1u) m |= (uint32_t)testBit(passBits[k], r + 1, c + 1) << k;
+        return m;
+    }
+
+    bool testBit(const std::vector<uint64_t> &b, int pr, int pc) const {
+        return (b[(size_t)pr * stride + ((size_t)pc >> 6)] >> (pc & 63)) & 1u;
+    }
+    void assignBit(std::vector<uint64_t> &b, int pr, int pc, bool v) {
+        uint64_t &w = b[(size_t)pr * stride + ((size_t)pc >> 6)];
+        uint64_t mask = uint64_t(1) << (pc & 63);
+        w = v ? (w | mask) : (w & ~mask);
+    }
+
+    bool ruleAllows(int k, int r, int c) const {
+        uint8_t mode = rules[k][typePlane[index(r, c)]];
+        return mode == PASS_ALWAYS || (mode == PASS_IF_MOVING && moving(r, c));
+    }
+
+    void refreshBits(int r, int c) {
+        for (int k = 0; k < nClasses; ++k) assignBit(passBits[k], r + 1, c + 1, ruleAllows(k, r, c));
+    }
+
+    void rebuildClass(int k) {
+        passBits[k].assign(stride * (nRows + 2), 0);
+        for (int r = 0; r < nRows; ++r)
+            for (int c = 0; c < nCols; ++c)
+                if (ruleAllows(k, r, c)) assignBit(passBits[k], r + 1, c + 1, true);
+    }
+
+    int nRows = 0, nCols = 0;
+    size_t stride = 0; // bitboard 每列的 word 數 (含左右各一格邊界)
+    std::vector<uint8_t> typePlane;
+    std::vector<int> waitPlane;
+    std::vector<VehicleId> occupantPlane;
+    std::vector<VehicleId> claimPlane;
+    std::vector<uint64_t> movingBits;
+    int nClasses = 0;
+    PassRule rules[MAX_PASS_CLASSES] = {};
+    std::vector<uint64_t> passBits[MAX_PASS_CLASSES];
+    int tileCols = 0;
+    std::vector<uint64_t> tileStamps;
+    uint32_t stampClasses = ~0u;
+    std::vector<int> *changeLog = nullptr;
+};
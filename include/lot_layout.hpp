@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// LotLayout：執行期載入的停車場地圖 (尺寸、入口、出口、車位都由檔案決定)
+//
+// 文字格式 (.lot)：
+//   # 註解
+//   lot <rows> <cols>
+//   接著 rows 行、每行 cols 個字元：
+//     '.' 通道   '#' 牆   'P' 車位   'E' 入口 (通道)   'X' 出口 (通道)
+// 二進位格式：
+//   "LOTB" + uint32 版本(1) + uint32 rows + uint32 cols + rows*cols 個位元組 (LayoutCell)
+// 讀檔時自動判斷格式；2000x2000 只需幾十毫秒
+// --------------------------------------------------------------------
+enum class LayoutCell : uint8_t { Aisle = 0, Wall = 1, Stall = 2, Entrance = 3, Exit = 4 };
+
+struct LotLayout {
+    int rows = 0, cols = 0;
+    std::vector<uint8_t> cells; // LayoutCell，row-major
+    std::vector<std::pair<int, int>> entrances;
+    std::vector<std::pair<int, int>> exits; // 沒有指定時與入口相同
+
+    LayoutCell at(int r, int c) const { return (LayoutCell)cells[(size_t)r * cols + c]; }
+
+    void reset(int r, int c) {
+        rows = r;
+        cols = c;
+        cells.assign((size_t)r * c, (uint8_t)LayoutCell::Aisle);
+        entrances.clear();
+        exits.clear();
+    }
+
+    void set(int r, int c, LayoutCell t) { cells[(size_t)r * cols + c] = (uint8_t)t; }
+
+    // 由 cells 重建入口 / 出口清單
+    void collectPortals() {
+        entrances.clear();
+        exits.clear();
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                LayoutCell t = at(r, c);
+                if (t == LayoutCell::Entrance) entrances.emplace_back(r, c);
+                if (t == LayoutCell::Exit) exits.emplace_back(r, c);
+            }
+        }
+        if (exits.empty()) exits = entrances;
+    }
+
+    size_t stallCount() const {
+        size_t n = 0;
+        for (uint8_t v : cells) n += (v == (uint8_t)LayoutCell::Stall);
+        return n;
+    }
+};
+
+namespace lot_layout_detail {
+static const char BINARY_MAGIC[4] = {'L', 'O', 'T', 'B'};
+static const uint32_t BINARY_VERSION = 1;
+
+inline bool readWholeFile(const std::string &path, std::string &data) {
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size < 0) {
+        std::fclose(f);
+        return false;
+    }
+    data.resize((size_t)size);
+    size_t got = size > 0 ? std::fread(&data[0], 1, (size_t)size, f) : 0;
+    std::fclose(f);
+    return got == (size_t)size;
+}
+
+inline bool parseBinary(const std::string &data, LotLayout &out, std::string &err) {
+    uint32_t header[3];
+    if (data.size() < 16) {
+        err = "binary layout too short";
+        return false;
+    }
+    std::memcpy(header, data.data() + 4, sizeof(header));
+    if (header[0] != BINARY_VERSION) {
+        err = "unsupported binary layout version " + std::to_string(header[0]);
+        return false;
+    }
+    size_t cells = (size_t)header[1] * header[2];
+    if (header[1] == 0 || header[2] == 0 || data.size() != 16 + cells) {
+        err = "binary layout size mismatch";
+        return false;
+    }
+    out.rows = (int)header[1];
+    out.cols = (int)header[2];
+    out.cells.assign(data.begin() + 16, data.end());
+    for (uint8_t v : out.cells) {
+        if (v > (uint8_t)LayoutCell::Exit) {
+            err = "bad cell code in binary layout";
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool parseText(const std::string &data, LotLayout &out, std::string &err) {
+    // 字元 -> LayoutCell，255 = 非法字元
+    uint8_t code[256];
+    std::memset(code, 255, sizeof(code));
+    code[(unsigned char)'.'] = (uint8_t)LayoutCell::Aisle;
+    code[(unsigned char)'#'] = (uint8_t)LayoutCell::Wall;
+    code[(unsigned char)'P'] = (uint8_t)LayoutCell::Stall;
+    code[(unsigned char)'E'] = (uint8_t)LayoutCell::Entrance;
+    code[(unsigned char)'X'] = (uint8_t)LayoutCell::Exit;
+
+    const char *p = data.data();
+    const char *end = p + data.size();
+    int row = -1, lineNo = 0;
+    while (p < end) {
+        const char *nl = (const char *)std::memchr(p, '\n', (size_t)(end - p));
+        const char *lineEnd = nl ? nl : end;
+        const char *next = nl ? nl + 1 : end;
+        if (lineEnd > p && lineEnd[-1] == '\r') --lineEnd;
+        ++lineNo;
+        size_t len = (size_t)(lineEnd - p);
+        if (len == 0 || (p[0] == '#' && row < 0)) {
+            p = next;
+            continue;
+        }
+        if (row < 0) {
+            int r = 0, c = 0;
+            std::string header(p, len);
+            if (std::sscanf(header.c_str(), "lot %d %d", &r, &c) != 2 || r <= 0 || c <= 0) {
+                err = "line " + std::to_string(lineNo) + ": expected 'lot <rows> <cols>'";
+                return false;
+            }
+            out.reset(r, c);
+            row = 0;
+        } else {
+            if (row >= out.rows) {
+                err = "line " + std::to_string(lineNo) + ": more than " + std::to_string(out.rows) + " rows";
+                return false;
+            }
+            if (len != (size_t)out.cols) {
+                err = "line " + std::to_string(lineNo) + ": expected " + std::to_string(out.cols) + " columns";
+                return false;
+            }
+            uint8_t *dst = &out.cells[(size_t)row * out.cols];
+            uint8_t bad = 0;
+            for (size_t i = 0; i < len; ++i) {
+                dst[i] = code[(unsigned char)p[i]];
+                bad |= (uint8_t)(dst[i] == 255);
+            }
+            if (bad) {
+                err = "line " + std::to_string(lineNo) + ": unknown cell character";
+                return false;
+            }
+            ++row;
+        }
+        p = next;
+    }
+    if (row != out.rows) {
+        err = "expected " + std::to_string(out.rows) + " rows, got " + std::to_string(row < 0 ? 0 : row);
+        return false;
+    }
+    return true;
+}
+} // namespace lot_layout_detail
+
+// 讀檔 (文字或二進位自動判斷)；失敗時回傳 false 並把原因寫進 err
+inline bool loadLotLayout(const std::string &path, LotLayout &out, std::string &err) {
+    using namespace lot_layout_detail;
+    std::string data;
+    if (!readWholeFile(path, data)) {
+        err = "cannot read " + path;
+        return false;
+    }
+    bool ok = data.size() >= 4 && std::memcmp(data.data(), BINARY_MAGIC, 4) == 0 ? parseBinary(data, out, err)
+                                                                                   : parseText(data, out, err);
+    if (!ok) return false;
+    out.collectPortals();
+    if (out.entrances.empty()) {
+        err = "layout has no entrance ('E')";
+        return false;
+    }
+    return true;
+}
+
+// 依副檔名 .lotb 寫二進位，其餘寫文字
+inline bool saveLotLayout(const std::string &path, const LotLayout &layout) {
+    using namespace lot_layout_detail;
+    FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool binary = path.size() >= 5 && path.compare(path.size() - 5, 5, ".lotb") == 0;
+    bool ok = true;
+    if (binary) {
+        uint32_t header[3] = {BINARY_VERSION, (uint32_t)layout.rows, (uint32_t)layout.cols};
+        ok = std::fwrite(BINARY_MAGIC, 1, 4, f) == 4 && std::fwrite(header, sizeof(header), 1, f) == 1 &&
+             std::fwrite(layout.cells.data(), 1, layout.cells.size(), f) == layout.cells.size();
+    } else {
+        static const char glyph[] = {'.', '#', 'P', 'E', 'X'};
+        std::fprintf(f, "lot %d %d\n", layout.rows, layout.cols);
+        std::string line((size_t)layout.cols + 1, '\n');
+        for (int r = 0; r < layout.rows && ok; ++r) {
+            for (int c = 0; c < layout.cols; ++c) line[c] = glyph[(int)layout.at(r, c)];
+            ok = std::fwrite(line.data(), 1, line.size(), f) == line.size();
+        }
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+// --------------------------------------------------------------------
+// generateLotLayout：產生任意大小、與 250919repath 同型態的地圖
+//   外圍一圈車位 (四角是牆)，入口在第 0 列；內部每 5 列一組「通道 / 牆 / 車位 / 車位 / 牆」，
+//   每 3 行留一條縱向通道，車位都貼著縱向通道
+// --------------------------------------------------------------------
+inline LotLayout generateLotLayout(int rows, int cols) {
+    LotLayout lot;
+    lot.reset(rows, cols);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            bool border = r == 0 || c == 0 || r == rows - 1 || c == cols - 1;
+            LayoutCell t = LayoutCell::Aisle;
+            if (border) {
+                bool corner = (r == 0 || r == rows - 1) && (c == 0 || c == cols - 1);
+                t = corner ? LayoutCell::Wall : LayoutCell::Stall;
+            } else if (r >= 2 && r <= rows - 3 && c >= 2 && c <= cols - 3 && (c - 1) % 3 != 0) {
+                int phase = (r - 1) % 5; // 0 = 通道列
+                if (phase == 1 || phase == 4) t = LayoutCell::Wall;
+                if (phase == 2 || phase == 3) t = LayoutCell::Stall;
+            }
+            lot.set(r, c, t);
+        }
+    }
+    int entranceCol = cols / 3 < 1 ? 1 : cols / 3;
+    lot.set(0, entranceCol, LayoutCell::Entrance);
+    if (entranceCol - 1 > 0) lot.set(0, entranceCol - 1, LayoutCell::Wall);
+    if (entranceCol + 1 < cols - 1) lot.set(0, entranceCol + 1, LayoutCell::Wall);
+    lot.collectPortals();
+    return lot;
+}
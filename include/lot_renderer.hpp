@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------
+// LotRenderer：地圖畫面輸出 (取代 displayStatus 裡的 system("cls") + 逐格 cout)
+//   模擬端只呼叫 publish()：把目前地圖轉成一份字元快照，與 renderer 交換 buffer 後立刻返回，不做任何 I/O；
+//   renderer 正在交換時 (try_lock 失敗) 直接丟掉這一份，模擬執行緒永遠不會等待
+//   renderer 執行緒以固定 fps 取最新的快照輸出：
+//     Ansi     第一次清畫面畫整張圖，之後只輸出「變動格子的游標移動 + 字元」；地圖下方設為捲動區，
+//              其他 log 在下面捲動，每次更新前後 save / restore 游標，不會打斷正在輸出的 log
+//     Plain    畫面有變動時輸出整張圖的文字 (沒有控制碼，適合寫進檔案)
+//     Headless publish 直接返回，不建立執行緒
+//   每次更新組成一個字串，以一次 fwrite 寫出
+// --------------------------------------------------------------------
+class LotRenderer {
+public:
+    enum class Mode { Headless, Ansi, Plain };
+
+    static bool parseMode(const std::string &s, Mode &mode) {
+        if (s == "headless") mode = Mode::Headless;
+        else if (s == "ansi") mode = Mode::Ansi;
+        else if (s == "plain") mode = Mode::Plain;
+        else return false;
+        return true;
+    }
+
+    explicit LotRenderer(Mode mode = Mode::Headless, int fps = 10) : mode(mode), fps(fps > 0 ? fps : 1) {
+        if (mode != Mode::Headless) worker = std::thread([this]() { loop(); });
+    }
+    ~LotRenderer() { stop(); }
+    LotRenderer(const LotRenderer &) = delete;
+    LotRenderer &operator=(const LotRenderer &) = delete;
+
+    bool active() const { return mode != Mode::Headless; }
+
+    // 模擬端：cellChar(r, c) 回傳該格顯示的字元；caption 顯示在地圖下方 (例如 tick)
+    template <class CellChar>
+    void publish(int rows, int cols, const std::string &caption, CellChar cellChar) {
+        if (mode == Mode::Headless) return;
+        staging.rows = rows;
+        staging.cols = cols;
+        staging.caption = caption;
+        staging.cells.resize((size_t)rows * cols);
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) staging.cells[(size_t)r * cols + c] = cellChar(r, c);
+        }
+        std::unique_lock<std::mutex> lk(mtx, std::try_to_lock);
+        if (!lk.owns_lock()) {
+            ++dropped;
+            return;
+        }
+        std::swap(staging, pending);
+        hasPending = true;
+    }
+
+    // 輸出最後一份快照並結束執行緒 (Ansi 時恢復整個畫面的捲動)
+    void stop() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    uint64_t framesWritten() const { return frames; }
+    uint64_t framesDropped() const { return dropped; }
+
+private:
+    struct Frame {
+        int rows = 0, cols = 0;
+        std::string caption;
+        std::vector<char> cells;
+    };
+
+    void loop() {
+        auto period = std::chrono::microseconds(1000000 / fps);
+        std::unique_lock<std::mutex> lk(mtx);
+        for (;;) {
+            wake.wait_for(lk, period, [this]() { return stopping; });
+            bool last = stopping;
+            if (hasPending) {
+                std::swap(pending, current);
+                hasPending = false;
+                lk.unlock();
+                draw();
+                lk.lock();
+            }
+            if (last) break;
+        }
+        if (mode == Mode::Ansi && drawn) write("\x1b" "7\x1b[r\x1b" "8");
+    }
+
+    void draw() {
+        out.clear();
+        if (mode == Mode::Plain) {
+            if (drawn && sameAsShown()) return;
+            appendFull();
+        } else if (!drawn || current.rows != shown.rows || current.cols != shown.cols) {
+            // 第一次 (或尺寸改變)：清畫面、畫整張圖，地圖下方設為捲動區
+            out += "\x1b[2J\x1b[H";
+            appendFull();
+            out += "\x1b[" + std::to_string(current.rows + 3) + "r";
+            out += "\x1b[" + std::to_string(current.rows + 3) + ";1H";
+        } else {
+            appendDiff();
+            if (out.empty()) return;
+            out = "\x1b" "7" + out + "\x1b" "8";
+        }
+        write(out);
+        shown = current;
+        drawn = true;
+        ++frames;
+    }
+
+    bool sameAsShown() const {
+        return current.rows == shown.rows && current.cols == shown.cols && current.caption == shown.caption &&
+               current.cells == shown.cells;
+    }
+
+    // 與 displayStatus 相同的版面：第一列為行號，每列以列號開頭，格子之間以空白分隔
+    void appendFull() {
+        out += "  ";
+        for (int c = 0; c < current.cols; ++c) {
+            out += (char)('0' + c % 10);
+            out += ' ';
+        }
+        out += '\n';
+        for (int r = 0; r < current.rows; ++r) {
+            out += (char)('0' + r % 10);
+            out += ' ';
+            for (int c = 0; c < current.cols; ++c) {
+                out += current.cells[(size_t)r * current.cols + c];
+                out += ' ';
+            }
+            out += '\n';
+        }
+        out += current.caption;
+        out += '\n';
+    }
+
+    // 畫面座標 (1-based)：格子 (r, c) 在第 r + 2 列、第 2c + 3 行；同一列連續變動的格子只移動一次游標
+    void appendDiff() {
+        for (int r = 0; r < current.rows; ++r) {
+            int next = -1; // 游標目前停在這一列的第 next 格 (-1 = 需要移動)
+            for (int c = 0; c < current.cols; ++c) {
+                size_t i = (size_t)r * current.cols + c;
+                if (current.cells[i] == shown.cells[i]) continue;
+                if (c == next) {
+                    out += current.cells[i];
+                } else if (c == next + 1 && next >= 0) { // 中間只隔一格：重寫那一格比移動游標短
+                    out += current.cells[i - 1];
+                    out += ' ';
+                    out += current.cells[i];
+                } else {
+                    out += "\x1b[" + std::to_string(r + 2) + ";" + std::to_string(2 * c + 3) + "H";
+                    out += current.cells[i];
+                }
+                out += ' ';
+                next = c + 1;
+            }
+        }
+        if (current.caption != shown.caption) {
+            out += "\x1b[" + std::to_string(current.rows + 2) + ";1H\x1b[2K";
+            out += current.caption;
+        }
+    }
+
+    static void write(const std::string &s) {
+        fwrite(s.data(), 1, s.size(), stdout);
+        fflush(stdout);
+    }
+
+    Mode mode;
+    int fps;
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable wake;
+    bool stopping = false;
+    bool hasPending = false;
+    Frame staging; // 模擬端填寫
+    Frame pending; // 最新一份快照 (受 mtx 保護)
+    Frame current; // renderer 正在輸出的
+    Frame shown;   // 畫面上目前的內容
+    bool drawn = false;
+    std::string out;
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> dropped{0};
+};
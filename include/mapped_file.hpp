@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// --------------------------------------------------------------------
+// MappedFile：唯讀 mmap 整個檔案 (Windows 讀進記憶體)
+//   trace_replay 的軌跡檔與 results_report 的 CSV 共用；空檔視為讀取失敗
+// --------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path, std::string &err) {
+        close();
+#ifdef _WIN32
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            err = "cannot open " + path;
+            return false;
+        }
+        owned.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (owned.empty()) {
+            err = "cannot read " + path;
+            return false;
+        }
+        ptr = (const uint8_t *)owned.data();
+        len = owned.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            err = "cannot open " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            err = "cannot read " + path;
+            return false;
+        }
+        void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            err = "cannot map " + path;
+            return false;
+        }
+        ptr = (const uint8_t *)p;
+        len = (size_t)st.st_size;
+        return true;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        owned.clear();
+#else
+        if (ptr) munmap((void *)ptr, len);
+#endif
+        ptr = nullptr;
+        len = 0;
+    }
+
+    const uint8_t *data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const uint8_t *ptr = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    std::string owned;
+#endif
+};
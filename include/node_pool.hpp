@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// SearchNode：A* 的精簡節點，只存 parent 索引，不再每個節點帶一份完整 path
+// --------------------------------------------------------------------
+struct SearchNode {
+    int row, col, g, h;
+    int parent; // -1 => 起點
+
+    int f() const { return g + h; }
+};
+
+// --------------------------------------------------------------------
+// NodePool：一次搜尋的節點 arena
+//   每次 push 只 append 一個 SearchNode，記憶體隨展開節點數線性成長
+//   找到終點時才沿 parent 回溯一次重建路徑
+// --------------------------------------------------------------------
+class NodePool {
+public:
+    void clear() { nodes.clear(); } // 保留 capacity，重複使用不再配置
+
+    int add(int row, int col, int g, int h, int parent) {
+        nodes.push_back(SearchNode{row, col, g, h, parent});
+        return (int)nodes.size() - 1;
+    }
+
+    const SearchNode &operator[](int idx) const { return nodes[idx]; }
+    size_t size() const { return nodes.size(); }
+    size_t capacity() const { return nodes.capacity(); }
+
+    void buildPath(int idx, std::vector<std::pair<int, int>> &out) const {
+        out.clear();
+        for (int i = idx; i != -1; i = nodes[i].parent) {
+            out.emplace_back(nodes[i].row, nodes[i].col);
+        }
+        std::reverse(out.begin(), out.end());
+    }
+
+private:
+    std::vector<SearchNode> nodes;
+};
+
+// open list 只放 (f, 節點索引)；比較規則與原本 Node::operator> 相同 (只看 f)
+struct OpenEntry {
+    int f;
+    int node;
+};
+
+struct OpenEntryGreater {
+    bool operator()(const OpenEntry &a, const OpenEntry &b) const { return a.f > b.f; }
+};
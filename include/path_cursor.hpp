@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// PathCursor：車輛沿路徑前進
+//   原本每前進一格做 path.erase(path.begin()) (O(L))，這裡只把游標往後移 (O(1))；
+//   [k] 以「目前所在格」為 0 的相對索引存取，與 erase 之後的 path[k] 相同
+//
+//   終點 waitTime 要用到剩餘路徑上的 Σ max(waitTime - k, 0) (waitTime != 0 的格子)
+//   原本每一步掃完整條剩餘路徑 (O(L))；但 waitTime 非 0 的格子只有各車終點附近那幾格，
+//   所以只記下「剩餘路徑上 waitTime 非 0 的位置」，每一步只算這幾格
+//   某格 waitTime 由 0 變非 0 時由呼叫端以 markWaiting() 通知 (變回 0 的格子在 waitSum 時順便移除)
+//   => 每一步 O(剩餘路徑上等待中的格數)，結果與整條重掃完全相同
+// --------------------------------------------------------------------
+class PathCursor {
+public:
+    using Cell = std::pair<int, int>;
+
+    PathCursor() = default;
+    PathCursor(std::vector<Cell> p) : cells(std::move(p)) {}
+
+    void reset(std::vector<Cell> p) {
+        cells = std::move(p);
+        pos = 0;
+        waiting.clear();
+    }
+
+    // 剩餘格數 (含目前所在格)
+    size_t size() const { return cells.size() - pos; }
+    bool empty() const { return pos >= cells.size(); }
+
+    const Cell &operator[](size_t k) const { return cells[pos + k]; }
+    const Cell &back() const { return cells.back(); }
+
+    // 前進一格
+    void advance() { ++pos; }
+
+    // 剩餘路徑 (重規劃時交給 replan worker)
+    std::vector<Cell> remaining() const {
+        return std::vector<Cell>(cells.begin() + (std::ptrdiff_t)pos, cells.end());
+    }
+
+    // 出發時整條掃一次，記下 waitTime 非 0 的位置並回傳 waitSum
+    template <class WaitOf>
+    int rebuildWaits(WaitOf waitOf) {
+        waiting.clear();
+        for (size_t j = pos; j + 1 < cells.size(); ++j) {
+            if (waitOf(cells[j].first, cells[j].second) != 0) waiting.push_back((uint32_t)j);
+        }
+        return waitSum(waitOf);
+    }
+
+    // (r, c) 的 waitTime 由 0 變非 0：在剩餘路徑 (不含終點) 上就記下來
+    //   這種轉換只在別台車出發 / 倒車結束時發生，這裡找位置的線性掃描不在每一步的路徑上
+    void markWaiting(int r, int c) {
+        for (size_t j = pos; j + 1 < cells.size(); ++j) {
+            if (cells[j].first != r || cells[j].second != c) continue;
+            if (std::find(waiting.begin(), waiting.end(), (uint32_t)j) == waiting.end())
+                waiting.push_back((uint32_t)j);
+            return;
+        }
+    }
+
+    // Σ max(waitTime - k, 0)，k = 與目前位置的距離；已走過或變回 0 的格子順便移除
+    template <class WaitOf>
+    int waitSum(WaitOf waitOf) {
+        int sum = 0;
+        for (size_t i = 0; i < waiting.size();) {
+            size_t j = waiting[i];
+            int w = j < pos ? 0 : waitOf(cells[j].first, cells[j].second);
+            if (w == 0) {
+                waiting[i] = waiting.back();
+                waiting.pop_back();
+                continue;
+            }
+            sum += std::max(w - (int)(j - pos), 0);
+            ++i;
+        }
+        return sum;
+    }
+
+    size_t waitingCount() const { return waiting.size(); }
+
+private:
+    std::vector<Cell> cells;
+    size_t pos = 0;
+    std::vector<uint32_t> waiting; // 剩餘路徑上 waitTime 非 0 的位置 (絕對索引)
+};
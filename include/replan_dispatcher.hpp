@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "work_steal_pool.hpp"
+
+// --------------------------------------------------------------------
+// ReplanDispatcher：重規劃的派工者
+//   submit() 把 move-only 的紀錄放進 priority queue (Before 決定先後，同序依送出順序)
+//   dispatch() 以 condition variable 叫醒派工執行緒，依優先序把紀錄交給 worker pool 平行處理
+//   wait() 等這一批做完，依同樣的優先序交回結果；shutdown() 處理完剩餘紀錄後結束執行緒
+// 呼叫端在 dispatch() 到 wait() 之間不要修改 handler 會讀的資料 (模擬時鐘在這段期間停住)
+// --------------------------------------------------------------------
+template <class Record, class Before>
+class ReplanDispatcher {
+public:
+    using Handler = std::function<void(Record &)>;
+    using Clock = std::chrono::steady_clock;
+
+    explicit ReplanDispatcher(Handler handler, unsigned workers = std::thread::hardware_concurrency())
+        : handler(std::move(handler)), pool(workers), dispatcher([this]() { dispatchLoop(); }) {}
+
+    ~ReplanDispatcher() { shutdown(); }
+
+    ReplanDispatcher(const ReplanDispatcher &) = delete;
+    ReplanDispatcher &operator=(const ReplanDispatcher &) = delete;
+
+    unsigned workerCount() const { return pool.size(); }
+
+    void submit(Record rec) {
+        std::lock_guard<std::mutex> lk(m);
+        queue.push_back(Item{std::move(rec), nextSeq++, Clock::now()});
+        std::push_heap(queue.begin(), queue.end(), Later());
+        ++outstanding;
+    }
+
+    bool hasPending() const {
+        std::lock_guard<std::mutex> lk(m);
+        return outstanding > 0;
+    }
+
+    void dispatch() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            released = true;
+        }
+        wakeCv.notify_one();
+    }
+
+    // 等所有已送出的紀錄處理完，依優先序回傳
+    std::vector<Record> wait() {
+        std::vector<Item> items;
+        {
+            std::unique_lock<std::mutex> lk(m);
+            doneCv.wait(lk, [this]() { return outstanding == 0; });
+            items.swap(done);
+        }
+        std::sort(items.begin(), items.end(), [](const Item &a, const Item &b) { return Later()(b, a); });
+        std::vector<Record> out;
+        out.reserve(items.size());
+        for (auto &it : items) out.push_back(std::move(it.rec));
+        return out;
+    }
+
+    std::vector<Record> flush() {
+        dispatch();
+        return wait();
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            if (stopping) return;
+            stopping = true;
+            released = true;
+        }
+        wakeCv.notify_one();
+        dispatcher.join();
+        pool.wait();
+    }
+
+    // submit 到 handler 完成的延遲 (微秒)
+    uint64_t handledCount() const {
+        std::lock_guard<std::mutex> lk(m);
+        return handled;
+    }
+    double meanLatencyUs() const {
+        std::lock_guard<std::mutex> lk(m);
+        return handled ? latencyNsSum / 1000.0 / handled : 0.0;
+    }
+    double maxLatencyUs() const {
+        std::lock_guard<std::mutex> lk(m);
+        return latencyNsMax / 1000.0;
+    }
+
+private:
+    struct Item {
+        Record rec;
+        uint64_t seq;
+        Clock::time_point submitted;
+    };
+    struct Later {
+        bool operator()(const Item &a, const Item &b) const {
+            if (Before()(b.rec, a.rec)) return true;
+            if (Before()(a.rec, b.rec)) return false;
+            return a.seq > b.seq;
+        }
+    };
+
+    void dispatchLoop() {
+        std::unique_lock<std::mutex> lk(m);
+        for (;;) {
+            wakeCv.wait(lk, [this]() { return released && (!queue.empty() || stopping); });
+            while (!queue.empty()) {
+                std::pop_heap(queue.begin(), queue.end(), Later());
+                auto item = std::make_shared<Item>(std::move(queue.back()));
+                queue.pop_back();
+                lk.unlock();
+                pool.submit([this, item]() { runItem(*item); });
+                lk.lock();
+            }
+            released = false;
+            if (stopping) return;
+        }
+    }
+
+    void runItem(Item &item) {
+        handler(item.rec);
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - item.submitted).count();
+        std::lock_guard<std::mutex> lk(m);
+        done.push_back(std::move(item));
+        ++handled;
+        latencyNsSum += ns;
+        latencyNsMax = std::max(latencyNsMax, ns);
+        if (--outstanding == 0) doneCv.notify_all();
+    }
+
+    Handler handler;
+    mutable std::mutex m;
+    std::condition_variable wakeCv;
+    std::condition_variable doneCv;
+    std::vector<Item> queue; // heap，依 Later 排序
+    std::vector<Item> done;
+    uint64_t nextSeq = 0;
+    size_t outstanding = 0;
+    bool released = false;
+    bool stopping = false;
+    uint64_t handled = 0;
+    uint64_t latencyNsSum = 0, latencyNsMax = 0;
+    WorkStealingPool pool;
+    std::thread dispatcher;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+// --------------------------------------------------------------------
+// ReservationTable：每一格的時間佔用區間 [start, end] (單位 tick，兩端都含)
+//   取代「一格只有一個 waitTime」的做法，同一格可以有任意多筆預約
+//   safe interval = 佔用區間之間的空檔，給 SIPP 使用
+// --------------------------------------------------------------------
+class ReservationTable {
+public:
+    static constexpr int FOREVER = INT_MAX;
+
+    struct Interval {
+        int start, end;
+        int owner;
+    };
+
+    void reset(int rows, int cols) {
+        nCols = cols;
+        cells.assign((size_t)rows * cols, {});
+    }
+
+    int index(int r, int c) const { return r * nCols + c; }
+
+    // 加入一筆預約，順便丟掉已經過期 (end < now) 的舊預約
+    void reserve(int r, int c, int start, int end, int owner, int now = INT_MIN) {
+        std::vector<Interval> &list = cells[index(r, c)];
+        if (now != INT_MIN) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [now](const Interval &iv) { return iv.end < now; }),
+                       list.end());
+        }
+        Interval iv{start, end, owner};
+        auto pos = std::lower_bound(list.begin(), list.end(), iv,
+                                    [](const Interval &a, const Interval &b) { return a.start < b.start; });
+        list.insert(pos, iv);
+    }
+
+    void releaseOwner(int owner) {
+        for (auto &list : cells) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [owner](const Interval &iv) { return iv.owner == owner; }),
+                       list.end());
+        }
+    }
+
+    bool isFree(int r, int c, int t) const {
+        for (const Interval &iv : cells[index(r, c)]) {
+            if (iv.start <= t && t <= iv.end) return false;
+        }
+        return true;
+    }
+
+    // 第 k 個 safe interval (依時間排序)；回傳 false 表示沒有第 k 個
+    // 佔用區間可能重疊 (保守預約)，因此以目前已掃過的最大 end 合併
+    bool safeInterval(int r, int c, int k, int &lo, int &hi) const {
+        const std::vector<Interval> &list = cells[index(r, c)];
+        int freeFrom = INT_MIN;
+        int found = 0;
+        for (const Interval &iv : list) {
+            if (iv.start > freeFrom) {
+                if (found == k) {
+                    lo = freeFrom;
+                    hi = iv.start - 1;
+                    return true;
+                }
+                ++found;
+            }
+            if (iv.end != FOREVER && iv.end + 1 > freeFrom) freeFrom = iv.end + 1;
+            if (iv.end == FOREVER) return false;
+        }
+        if (found == k) {
+            lo = freeFrom;
+            hi = FOREVER;
+            return true;
+        }
+        return false;
+    }
+
+    size_t reservationCount() const {
+        size_t n = 0;
+        for (auto &list : cells) n += list.size();
+        return n;
+    }
+
+private:
+    int nCols = 0;
+    std::vector<std::vector<Interval>> cells;
+};
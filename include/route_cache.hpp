@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lot_grid.hpp"
+
+// --------------------------------------------------------------------
+// RouteDeps：一次搜尋讀過哪些區塊 (每個規劃執行緒一份)
+//   規劃器在展開 / 跳過每一格時呼叫 addCell；鄰居落在隔壁區塊時一併記下
+// --------------------------------------------------------------------
+class RouteDeps {
+public:
+    static RouteDeps &local() {
+        thread_local RouteDeps deps;
+        return deps;
+    }
+
+    void begin(const LotGrid &g) {
+        grid = &g;
+        if (mark.size() < (size_t)g.tileCount()) {
+            mark.assign(g.tileCount(), 0);
+            generation = 0;
+        }
+        if (++generation == 0) {
+            std::fill(mark.begin(), mark.end(), 0);
+            generation = 1;
+        }
+        deps.clear();
+    }
+
+    void addCell(int r, int c) {
+        addTile(r, c);
+        int tr = r & (LotGrid::TILE - 1), tc = c & (LotGrid::TILE - 1);
+        if (tr == 0 && r > 0) addTile(r - 1, c);
+        if (tr == LotGrid::TILE - 1 && r + 1 < grid->rows()) addTile(r + 1, c);
+        if (tc == 0 && c > 0) addTile(r, c - 1);
+        if (tc == LotGrid::TILE - 1 && c + 1 < grid->cols()) addTile(r, c + 1);
+    }
+
+    // (區塊, 搜尋當下的戳記)
+    const std::vector<std::pair<int, uint64_t>> &tiles() const { return deps; }
+
+private:
+    void addTile(int r, int c) {
+        int t = grid->tileIndex(r, c);
+        if (mark[t] == generation) return;
+        mark[t] = generation;
+        deps.emplace_back(t, grid->tileStamp(t));
+    }
+
+    const LotGrid *grid = nullptr;
+    std::vector<uint32_t> mark;
+    uint32_t generation = 0;
+    std::vector<std::pair<int, uint64_t>> deps;
+};
+
+// --------------------------------------------------------------------
+// RouteCache：(起點, 終點, 規劃模式) -> 路線
+//   每筆記錄搜尋讀過的區塊與當時的戳記；查詢時區塊戳記全部沒變 => 同一份輸入，
+//   搜尋結果必定相同，直接回傳快取的路線 (不改變模擬結果)
+//   區塊改變 (CLOSED_AISLE、setCellType、車輛移動、waitTime 更新) 時戳記換新，舊記錄自然失效；
+//   heuristic 改變 (ALT 距離表更新) 時以 invalidateAll() 推進整體 epoch
+//   可由多個執行緒同時查詢 (statisticlog 批次的各個複本共用一份)
+// --------------------------------------------------------------------
+class RouteCache {
+public:
+    struct Key {
+        int sr, sc, er, ec;
+        uint32_t mode; // 規劃模式 (各程式自行編碼：改良 / JPS / 迴轉 / 角色…)
+
+        bool operator==(const Key &o) const {
+            return sr == o.sr && sc == o.sc && er == o.er && ec == o.ec && mode == o.mode;
+        }
+    };
+
+    struct Stats {
+        uint64_t lookups;
+        uint64_t hits;
+        uint64_t stale;      // 有記錄但區塊已改變
+        uint64_t hitNanos;   // 命中時查詢花費
+        uint64_t missNanos;  // 未命中時查詢 + 搜尋花費
+        uint64_t misses() const { return lookups - hits; }
+    };
+
+    static constexpr size_t ENTRIES_PER_KEY = 4; // 同一組查詢保留幾個不同狀態的結果
+
+    bool lookup(const Key &key, const LotGrid &grid, std::vector<std::pair<int, int>> &path) {
+        lookups.fetch_add(1, std::memory_order_relaxed);
+        std::vector<std::shared_ptr<const Entry>> candidates;
+        uint64_t now;
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            auto it = table.find(key);
+            if (it == table.end()) return false;
+            candidates = it->second;
+            now = epoch;
+        }
+        for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+            if ((*it)->epoch == now && stillValid(**it, grid)) {
+                path = (*it)->path;
+                (*it)->hits.fetch_add(1, std::memory_order_relaxed);
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        stale.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void store(const Key &key, const std::vector<std::pair<int, int>> &path, const RouteDeps &deps) {
+        auto e = std::make_shared<Entry>();
+        e->path = path;
+        e->deps = deps.tiles();
+        for (const auto &d : e->deps) e->newestStamp = std::max(e->newestStamp, d.second);
+        std::lock_guard<std::mutex> lk(mtx);
+        e->epoch = epoch;
+        std::vector<std::shared_ptr<const Entry>> &slot = table[key];
+        if (slot.size() >= ENTRIES_PER_KEY) {
+            // 丟掉命中最少的；同樣少時丟「依賴的戳記最新」的：
+            //   戳記越舊的狀態越可能被其他複本共用 (例如 baseLot 剛複製出來的空停車場)，
+            //   車輛移動後才出現的狀態多半只出現一次
+            size_t victim = slot.size();
+            for (size_t i = 0; i < slot.size(); ++i) {
+                if (victim == slot.size() || worseThan(*slot[i], *slot[victim])) victim = i;
+            }
+            if (!worseThan(*slot[victim], *e)) return; // 新的這筆最不值得留
+            slot.erase(slot.begin() + victim);
+        }
+        slot.push_back(std::move(e));
+    }
+
+    void invalidateAll() {
+        std::lock_guard<std::mutex> lk(mtx);
+        ++epoch;
+        table.clear();
+    }
+
+    void addHitTime(uint64_t ns) { hitNanos.fetch_add(ns, std::memory_order_relaxed); }
+    void addMissTime(uint64_t ns) { missNanos.fetch_add(ns, std::memory_order_relaxed); }
+
+    Stats stats() const {
+        return Stats{lookups.load(), hits.load(), stale.load(), hitNanos.load(), missNanos.load()};
+    }
+
+private:
+    struct Entry {
+        std::vector<std::pair<int, int>> path;
+        std::vector<std::pair<int, uint64_t>> deps;
+        uint64_t epoch = 0;
+        uint64_t newestStamp = 0;
+        mutable std::atomic<uint32_t> hits{0};
+    };
+
+    // a 比 b 更該被淘汰
+    static bool worseThan(const Entry &a, const Entry &b) {
+        uint32_t ha = a.hits.load(std::memory_order_relaxed), hb = b.hits.load(std::memory_order_relaxed);
+        if (ha != hb) return ha < hb;
+        return a.newestStamp > b.newestStamp;
+    }
+    struct KeyHash {
+        size_t operator()(const Key &k) const {
+            uint64_t h = (uint64_t)(uint32_t)k.sr * 0x9E3779B97F4A7C15ULL;
+            h ^= (uint64_t)(uint32_t)k.sc + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+            h ^= (uint64_t)(uint32_t)k.er + 0x85EBCA77C2B2AE63ULL + (h << 6) + (h >> 2);
+            h ^= (uint64_t)(uint32_t)k.ec + 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+            h ^= (uint64_t)k.mode + 0x165667B19E3779F9ULL + (h << 6) + (h >> 2);
+            return (size_t)h;
+        }
+    };
+
+    static bool stillValid(const Entry &e, const LotGrid &grid) {
+        for (const auto &d : e.deps) {
+            if (d.first >= grid.tileCount() || grid.tileStamp(d.first) != d.second) return false;
+        }
+        return true;
+    }
+
+    std::mutex mtx;
+    std::unordered_map<Key, std::vector<std::shared_ptr<const Entry>>, KeyHash> table;
+    uint64_t epoch = 0;
+    std::atomic<uint64_t> lookups{0}, hits{0}, stale{0}, hitNanos{0}, missNanos{0};
+};
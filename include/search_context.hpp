@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "node_pool.hpp"
+
+// --------------------------------------------------------------------
+// SearchContext：每個規劃執行緒一份、可重複使用的 A* 工作區
+//   cost / closed 為一維陣列，以 generation 標記，begin() 只需 O(1) 重設
+//   open list 與 NodePool 保留上次的 capacity，穩定後每次搜尋幾乎不配置記憶體
+// --------------------------------------------------------------------
+class SearchContext {
+public:
+    // 全部執行緒累計的統計 (每次搜尋結束時 finish() 加總一次)
+    struct Totals {
+        uint64_t searches;
+        uint64_t expansions;         // 展開 (從 open list 取出且未 closed) 的節點數
+        uint64_t allocations;        // 工作區實際做的配置次數
+        uint64_t avoidedAllocations; // 相較「每次都重新配置 cost 陣列 + pq」省下的次數 (估計)
+        uint64_t avoidedBytes;       // 完全沒有配置的搜尋所省下的位元組
+    };
+
+    static SearchContext &local() {
+        thread_local SearchContext ctx;
+        return ctx;
+    }
+
+    static Totals totals() {
+        return Totals{counters().searches.load(), counters().expansions.load(), counters().allocations.load(),
+                      counters().avoidedAllocations.load(), counters().avoidedBytes.load()};
+    }
+
+    void begin(int rows, int cols) {
+        curRows = rows;
+        curCols = cols;
+        size_t cells = (size_t)rows * cols;
+        allocsAtBegin = allocs;
+        if (costVal.size() < cells) {
+            costVal.resize(cells);
+            costStamp.assign(cells, 0);
+            closedStamp.assign(cells, 0);
+            allocs += 3;
+            generation = 0;
+        }
+        if (++generation == 0) { // 繞回 0 時才真的清一次
+            std::fill(costStamp.begin(), costStamp.end(), 0);
+            std::fill(closedStamp.begin(), closedStamp.end(), 0);
+            generation = 1;
+        }
+        open.clear();
+        pool.clear();
+        peakOpen = 0;
+        expanded = 0;
+        openCapAtBegin = open.capacity();
+        poolCapAtBegin = pool.capacity();
+    }
+
+    int index(int r, int c) const { return r * curCols + c; }
+
+    int cost(int idx) const { return costStamp[idx] == generation ? costVal[idx] : INT_MAX; }
+    void setCost(int idx, int v) {
+        costVal[idx] = v;
+        costStamp[idx] = generation;
+    }
+
+    bool isClosed(int idx) const { return closedStamp[idx] == generation; }
+    void close(int idx) {
+        closedStamp[idx] = generation;
+        ++expanded;
+    }
+
+    // 與 std::priority_queue 相同的 push_heap / pop_heap 順序
+    void pushOpen(OpenEntry e) {
+        open.push_back(e);
+        std::push_heap(open.begin(), open.end(), OpenEntryGreater());
+        if (open.size() > peakOpen) peakOpen = open.size();
+    }
+    OpenEntry popOpen() {
+        std::pop_heap(open.begin(), open.end(), OpenEntryGreater());
+        OpenEntry e = open.back();
+        open.pop_back();
+        return e;
+    }
+    bool openEmpty() const { return open.empty(); }
+
+    // 這次搜尋到目前為止的展開數與 open list 峰值
+    uint64_t expandedCount() const { return expanded; }
+    size_t peakOpenSize() const { return peakOpen; }
+
+    void finish() {
+        if (open.capacity() != openCapAtBegin) allocs += growthAllocs(open.capacity(), openCapAtBegin);
+        if (pool.capacity() != poolCapAtBegin) allocs += growthAllocs(pool.capacity(), poolCapAtBegin);
+
+        // 原本每次搜尋：vector<vector<int>> cost (rows+1 次) + pq / 節點陣列從 0 長到峰值
+        uint64_t legacyAllocs = (uint64_t)curRows + 1 + growthAllocs(peakOpen, 0) + growthAllocs(pool.size(), 0);
+        uint64_t legacyBytes = (uint64_t)curRows * curCols * sizeof(int) +
+                               2 * peakOpen * sizeof(OpenEntry) + 2 * pool.size() * sizeof(SearchNode);
+        uint64_t used = allocs - allocsAtBegin;
+
+        Counters &c = counters();
+        c.searches.fetch_add(1, std::memory_order_relaxed);
+        c.expansions.fetch_add(expanded, std::memory_order_relaxed);
+        c.allocations.fetch_add(used, std::memory_order_relaxed);
+        if (legacyAllocs > used) c.avoidedAllocations.fetch_add(legacyAllocs - used, std::memory_order_relaxed);
+        if (used == 0) c.avoidedBytes.fetch_add(legacyBytes, std::memory_order_relaxed);
+    }
+
+    NodePool pool;
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> searches{0};
+        std::atomic<uint64_t> expansions{0};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> avoidedAllocations{0};
+        std::atomic<uint64_t> avoidedBytes{0};
+    };
+    static Counters &counters() {
+        static Counters c;
+        return c;
+    }
+
+    // vector 以倍增成長時，capacity 從 from 長到 to 大約經過幾次配置
+    static uint64_t growthAllocs(size_t to, size_t from) {
+        uint64_t n = 0;
+        for (size_t cap = from ? from : 1; cap < to; cap *= 2) ++n;
+        return n + (from == 0 && to > 0 ? 1 : 0);
+    }
+
+    std::vector<int> costVal;
+    std::vector<uint32_t> costStamp;
+    std::vector<uint32_t> closedStamp;
+    uint32_t generation = 0;
+    std::vector<OpenEntry> open;
+    int curRows = 0, curCols = 0;
+    size_t peakOpen = 0;
+    uint64_t expanded = 0;
+    size_t openCapAtBegin = 0, poolCapAtBegin = 0;
+    uint64_t allocs = 0, allocsAtBegin = 0;
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// SearchStats：每一次 A* 搜尋的計數
+//   展開節點數、push 次數、stale pop (已 closed 的重複項目)、open list 峰值、路徑長度、
+//   waitTime 懲罰 (搜尋中加上的總和 / 最後路線上的部分)、耗時
+//   以 -DSEARCH_STATS=ON 編譯 (定義 SEARCH_STATS) 才啟用；否則 SEARCH_STAT(...) 展開成空，
+//   搜尋迴圈完全沒有額外的指令
+//   記錄 append 到各執行緒自己的 buffer (第一次使用時登記一次)，搜尋期間沒有共用的鎖；
+//   export 時才合併，輸出 CSV 或 JSON，以 (run, planner) 對應結果檔的 RunID 與傳統 / 改良組
+// --------------------------------------------------------------------
+#ifdef SEARCH_STATS
+#define SEARCH_STAT(stmt) stmt
+#else
+#define SEARCH_STAT(stmt) ((void)0)
+#endif
+
+struct SearchRecord {
+    std::string run;     // 結果檔的 RunID (statisticlog) / seed (repath)
+    const char *planner; // "traditional" / "improved"
+    uint32_t vehicle;
+    int sr, sc, er, ec;
+    bool found;
+    bool cached;            // 由 RouteCache 直接回傳，沒有搜尋
+    uint64_t expanded;
+    uint64_t pushes;
+    uint64_t stalePops;
+    uint64_t peakOpen;
+    uint64_t penalizedPushes;   // 加了 waitTime 懲罰的鄰居數
+    int64_t waitPenaltyAdded;   // 搜尋中加上的懲罰總和
+    int64_t pathWaitPenalty;    // 最後路線上的懲罰 (終點 g - 步數)
+    int pathLength;
+    uint64_t nanos;
+};
+
+class SearchStats {
+public:
+    static constexpr bool enabled() {
+#ifdef SEARCH_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // 之後這個執行緒上的搜尋都標記為這個 run
+    static void setRun(std::string run) { threadRun() = std::move(run); }
+    // 沒有 setRun 的執行緒 (例如 replan worker) 使用的 run；須在搜尋開始前設定
+    static void setDefaultRun(std::string run) { defaultRun() = std::move(run); }
+    static const std::string &run() { return threadRun().empty() ? defaultRun() : threadRun(); }
+
+    static void record(SearchRecord &&r) { buffer().push_back(std::move(r)); }
+
+    // 合併所有執行緒的記錄 (呼叫時不可有搜尋在進行)
+    static std::vector<SearchRecord> collect() {
+        std::vector<SearchRecord> all;
+        std::lock_guard<std::mutex> lk(registry().mtx);
+        for (auto &b : registry().buffers) all.insert(all.end(), b->begin(), b->end());
+        return all;
+    }
+
+    static size_t count() {
+        size_t n = 0;
+        std::lock_guard<std::mutex> lk(registry().mtx);
+        for (auto &b : registry().buffers) n += b->size();
+        return n;
+    }
+
+    // 副檔名 .json => JSON 陣列，其他 => CSV
+    static bool exportFile(const std::string &path) {
+        std::ofstream out(path);
+        if (!out) return false;
+        std::vector<SearchRecord> all = collect();
+        bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        if (json) out << "[\n";
+        else out << "run,planner,vehicle,sr,sc,er,ec,found,cached,expanded,pushes,stale_pops,peak_open,"
+                    "penalized_pushes,wait_penalty_added,path_wait_penalty,path_length,nanos\n";
+        for (size_t i = 0; i < all.size(); ++i) {
+            const SearchRecord &r = all[i];
+            if (json) {
+                out << "  {\"run\": \"" << r.run << "\", \"planner\": \"" << r.planner << "\", \"vehicle\": "
+                    << r.vehicle << ", \"sr\": " << r.sr << ", \"sc\": " << r.sc << ", \"er\": " << r.er
+                    << ", \"ec\": " << r.ec << ", \"found\": " << (r.found ? "true" : "false")
+                    << ", \"cached\": " << (r.cached ? "true" : "false") << ", \"expanded\": " << r.expanded
+                    << ", \"pushes\": " << r.pushes << ", \"stale_pops\": " << r.stalePops
+                    << ", \"peak_open\": " << r.peakOpen << ", \"penalized_pushes\": " << r.penalizedPushes
+                    << ", \"wait_penalty_added\": " << r.waitPenaltyAdded
+                    << ", \"path_wait_penalty\": " << r.pathWaitPenalty << ", \"path_length\": " << r.pathLength
+                    << ", \"nanos\": " << r.nanos << "}" << (i + 1 < all.size() ? "," : "") << "\n";
+            } else {
+                out << r.run << ',' << r.planner << ',' << r.vehicle << ',' << r.sr << ',' << r.sc << ',' << r.er
+                    << ',' << r.ec << ',' << r.found << ',' << r.cached << ',' << r.expanded << ',' << r.pushes
+                    << ',' << r.stalePops << ',' << r.peakOpen << ',' << r.penalizedPushes << ','
+                    << r.waitPenaltyAdded << ',' << r.pathWaitPenalty << ',' << r.pathLength << ',' << r.nanos
+                    << '\n';
+            }
+        }
+        if (json) out << "]\n";
+        return (bool)out;
+    }
+
+private:
+    using Buffer = std::vector<SearchRecord>;
+    struct Registry {
+        std::mutex mtx;
+        std::vector<std::shared_ptr<Buffer>> buffers; // 執行緒結束後記錄仍保留在這裡
+    };
+    static Registry &registry() {
+        static Registry r;
+        return r;
+    }
+    static Buffer &buffer() {
+        thread_local std::shared_ptr<Buffer> buf = [] {
+            auto b = std::make_shared<Buffer>();
+            std::lock_guard<std::mutex> lk(registry().mtx);
+            registry().buffers.push_back(b);
+            return b;
+        }();
+        return *buf;
+    }
+    static std::string &threadRun() {
+        thread_local std::string r;
+        return r;
+    }
+    static std::string &defaultRun() {
+        static std::string r;
+        return r;
+    }
+};
+
+// --------------------------------------------------------------------
+// SearchProbe：一次搜尋的計數器 (放在規劃函式的區域變數，只在 SEARCH_STAT(...) 裡使用)
+//   finish() 記下結果；沒呼叫 finish 就離開 (找不到路線) 時由解構子記為 found = false
+// --------------------------------------------------------------------
+class SearchProbe {
+public:
+    SearchProbe(const char *planner, uint32_t vehicle, int sr, int sc, int er, int ec)
+        : t0(std::chrono::steady_clock::now()) {
+        rec = SearchRecord{SearchStats::run(), planner, vehicle, sr, sc, er, ec, false, false, 0, 0, 0, 0, 0, 0,
+                           0, 0, 0};
+    }
+    ~SearchProbe() {
+        if (!done) commit();
+    }
+    SearchProbe(const SearchProbe &) = delete;
+    SearchProbe &operator=(const SearchProbe &) = delete;
+
+    void push() { ++rec.pushes; }
+    void stalePop() { ++rec.stalePops; }
+    void penalty(int extra) {
+        if (extra <= 0) return;
+        ++rec.penalizedPushes;
+        rec.waitPenaltyAdded += extra;
+    }
+
+    // 展開數與 open 峰值由 SearchContext 提供
+    template <class Context>
+    void searched(const Context &ctx) {
+        rec.expanded = ctx.expandedCount();
+        rec.peakOpen = ctx.peakOpenSize();
+    }
+
+    void cached(size_t pathLength) {
+        rec.cached = true;
+        finish(true, pathLength, -1);
+    }
+
+    // goalG < 0 => 不知道終點 g (快取命中)
+    void finish(bool found, size_t pathLength, int goalG) {
+        rec.found = found;
+        rec.pathLength = (int)pathLength;
+        if (found && goalG >= 0 && pathLength > 0) rec.pathWaitPenalty = goalG - (int64_t)(pathLength - 1);
+        commit();
+    }
+
+private:
+    void commit() {
+        done = true;
+        rec.nanos = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - t0)
+                        .count();
+        SearchStats::record(std::move(rec));
+    }
+
+    SearchRecord rec;
+    std::chrono::steady_clock::time_point t0;
+    bool done = false;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------
+// SimClock：離散事件模擬時鐘 (1 tick = 原本的 1 秒)
+//   virtual 模式：事件依 (tick, 排入順序) 執行，時間直接跳到下一個事件，完全不 sleep
+//   realtime 模式：同一份事件佇列，只是每個事件等到牆上時間 origin + tick 秒才執行
+// 同一 tick 內的事件依排入順序執行，因此兩種模式在同一個 seed 下結果完全相同。
+//
+// agent：每 tick 推進一次的狀態機 (車輛)。同一 tick 的 agent 合併成一個「推進」事件，
+//   在一個連續的 vector 裡依序呼叫，不必每台車每 tick 各配置、排入一個事件；
+//   順序與每台車自己 scheduleAfter(1) 完全相同 (依上一 tick 排入的順序)
+// --------------------------------------------------------------------
+class SimClock {
+public:
+    using Tick = long long;
+    using Action = std::function<void()>;
+    using AgentStep = std::function<bool()>; // 回傳 true = 下一 tick 繼續推進
+
+    explicit SimClock(bool realtime = false) : realtime(realtime) {}
+
+    bool isRealtime() const { return realtime; }
+
+    Tick now() const { return current; }
+
+    void schedule(Tick at, Action fn) {
+        if (at < current) at = current;
+        events.push_back(Event{at, nextSeq++, std::move(fn)});
+        std::push_heap(events.begin(), events.end(), Later());
+    }
+
+    void scheduleAfter(Tick delay, Action fn) {
+        schedule(current + delay, std::move(fn));
+    }
+
+    // 從下一 tick 開始推進，直到 step 回傳 false
+    void addAgent(AgentStep step) {
+        Tick at = current + 1;
+        for (AgentBatch &b : batches) {
+            if (b.at == at) {
+                b.steps.push_back(std::move(step));
+                return;
+            }
+        }
+        batches.push_back(AgentBatch{at, std::move(spare)});
+        spare.clear();
+        batches.back().steps.push_back(std::move(step));
+        schedule(at, [this, at]() { stepAgents(at); });
+    }
+
+    // 每個 tick 的事件全部執行完、時間前進之前呼叫一次 (例如交出地圖快照)；沒設定時沒有額外成本
+    void setTickObserver(std::function<void(Tick)> fn) { tickObserver = std::move(fn); }
+
+    // 執行事件直到佇列清空，或下一個事件晚於 until
+    void run(Tick until = LLONG_MAX) {
+        auto origin = std::chrono::steady_clock::now() - std::chrono::seconds(current);
+        while (!events.empty() && events.front().at <= until) {
+            std::pop_heap(events.begin(), events.end(), Later());
+            Event ev = std::move(events.back());
+            events.pop_back();
+            if (tickObserver && ev.at != current) tickObserver(current);
+            if (realtime) {
+                std::this_thread::sleep_until(origin + std::chrono::seconds(ev.at));
+            }
+            current = ev.at;
+            ++processed;
+            ev.fn();
+        }
+        if (tickObserver) tickObserver(current);
+    }
+
+    bool idle() const { return events.empty(); }
+    size_t pendingEvents() const { return events.size(); }
+    uint64_t processedEvents() const { return processed; }
+    size_t pendingAgents() const {
+        size_t n = 0;
+        for (const AgentBatch &b : batches) n += b.steps.size();
+        return n;
+    }
+    uint64_t agentSteps() const { return steps; }
+
+private:
+    struct Event {
+        Tick at;
+        uint64_t seq;
+        Action fn;
+    };
+    struct Later {
+        bool operator()(const Event &a, const Event &b) const {
+            return a.at != b.at ? a.at > b.at : a.seq > b.seq;
+        }
+    };
+
+    // 同一 tick 到期的 agent (最多兩批待推進：本 tick 尚未推進的、與下一 tick 的)
+    struct AgentBatch {
+        Tick at;
+        std::vector<AgentStep> steps;
+    };
+
+    // 這一批依序推進；要繼續的排進下一 tick，用完的 vector 留給下一批沿用容量
+    void stepAgents(Tick at) {
+        auto it = std::find_if(batches.begin(), batches.end(), [at](const AgentBatch &b) { return b.at == at; });
+        std::vector<AgentStep> stepping = std::move(it->steps);
+        batches.erase(it);
+        for (AgentStep &step : stepping) {
+            ++steps;
+            if (step()) addAgent(std::move(step));
+        }
+        stepping.clear();
+        spare = std::move(stepping);
+    }
+
+    bool realtime;
+    Tick current = 0;
+    uint64_t nextSeq = 0;
+    uint64_t processed = 0;
+    std::vector<Event> events;
+    std::vector<AgentBatch> batches;
+    std::vector<AgentStep> spare;
+    uint64_t steps = 0;
+    std::function<void(Tick)> tickObserver;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "reservation_table.hpp"
+
+// --------------------------------------------------------------------
+// Safe Interval Path Planning (SIPP)
+//   狀態 = (格子, 該格第幾個 safe interval)，g = 最早抵達的 tick
+//   移動與原地等待都是 1 tick；車在格子上的佔用為 [抵達, 離開] (含離開那個 tick)
+//   因此從 u 出發、在 t 抵達 v 需要：t >= g_u + 1、t 仍在 u 的 interval 內、t 在 v 的 interval 內
+//   終點要能再停 holdTicks (倒車) 不被別人預約
+// --------------------------------------------------------------------
+struct SippStats {
+    long long expanded = 0;
+    long long generated = 0;
+};
+
+namespace sipp_detail {
+struct Node {
+    int row, col, interval;
+    int g, h;
+    int parent;
+};
+struct Open {
+    int f, g, node;
+};
+struct OpenGreater {
+    bool operator()(const Open &a, const Open &b) const {
+        return a.f != b.f ? a.f > b.f : a.g < b.g; // 同 f 時優先展開 g 大 (較接近終點) 的狀態
+    }
+};
+} // namespace sipp_detail
+
+// passable(r, c)：不會移動的障礙 (牆、車位上的車) 為 false；行駛中的車輛由 ReservationTable 表示
+// outPath：從 startTick 起每個 tick 所在的格子，原地等待會重複出現同一格
+template <class Passable>
+bool sippPlan(const ReservationTable &rt, int rows, int cols, int sr, int sc, int startTick,
+              int er, int ec, int holdTicks, Passable passable,
+              std::vector<std::pair<int, int>> &outPath, SippStats *stats = nullptr,
+              int maxExpansions = 200000) {
+    using namespace sipp_detail;
+    auto manhattan = [&](int r, int c) { return std::abs(er - r) + std::abs(ec - c); };
+
+    // 起點：包含 startTick 的 interval；若起點正被佔用，則在入口外等到下一個 interval
+    int startInterval = -1, departAt = startTick;
+    for (int k = 0;; ++k) {
+        int lo, hi;
+        if (!rt.safeInterval(sr, sc, k, lo, hi)) break;
+        if (hi < startTick) continue;
+        startInterval = k;
+        departAt = std::max(lo, startTick);
+        break;
+    }
+    if (startInterval < 0) return false;
+
+    std::vector<Node> nodes;
+    std::vector<Open> open;
+    std::unordered_map<long long, int> bestG; // (cell, interval) -> g
+    auto key = [cols](int r, int c, int k) { return ((long long)(r * cols + c) << 20) | k; };
+
+    nodes.push_back(Node{sr, sc, startInterval, departAt - startTick, manhattan(sr, sc), -1});
+    open.push_back(Open{nodes[0].g + nodes[0].h, nodes[0].g, 0});
+    bestG[key(sr, sc, startInterval)] = nodes[0].g;
+
+    static const int DR[4] = {-1, 1, 0, 0};
+    static const int DC[4] = {0, 0, -1, 1};
+    long long expanded = 0;
+    int goalNode = -1;
+
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), OpenGreater());
+        Open top = open.back();
+        open.pop_back();
+        Node cur = nodes[top.node];
+        auto it = bestG.find(key(cur.row, cur.col, cur.interval));
+        if (it != bestG.end() && it->second < cur.g) continue; // stale
+
+        int curLo = 0, curHi = 0;
+        if (!rt.safeInterval(cur.row, cur.col, cur.interval, curLo, curHi)) continue; // 不應發生：節點只由存在的 interval 產生
+        int absG = startTick + cur.g;
+
+        if (cur.row == er && cur.col == ec &&
+            (curHi == ReservationTable::FOREVER || curHi >= absG + holdTicks)) {
+            goalNode = top.node;
+            break;
+        }
+        if (++expanded > maxExpansions) break;
+
+        for (int d = 0; d < 4; ++d) {
+            int nr = cur.row + DR[d], nc = cur.col + DC[d];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols || !passable(nr, nc)) continue;
+            for (int k = 0;; ++k) {
+                int lo, hi;
+                if (!rt.safeInterval(nr, nc, k, lo, hi)) break;
+                if (lo > curHi) break; // 之後的 interval 都來不及離開目前這格
+                int t = std::max(absG + 1, lo);
+                if (t > hi || t > curHi) continue;
+                int g = t - startTick;
+                long long kk = key(nr, nc, k);
+                auto bit = bestG.find(kk);
+                if (bit != bestG.end() && bit->second <= g) continue;
+                bestG[kk] = g;
+                nodes.push_back(Node{nr, nc, k, g, manhattan(nr, nc), top.node});
+                open.push_back(Open{g + nodes.back().h, g, (int)nodes.size() - 1});
+                std::push_heap(open.begin(), open.end(), OpenGreater());
+            }
+        }
+    }
+    if (stats) {
+        stats->expanded += expanded;
+        stats->generated += (long long)nodes.size();
+    }
+    if (goalNode < 0) return false;
+
+    // 由 parent 回溯，展開成每個 tick 的位置 (等待 => 重複同一格)
+    std::vector<int> chain;
+    for (int i = goalNode; i != -1; i = nodes[i].parent) chain.push_back(i);
+    std::reverse(chain.begin(), chain.end());
+    outPath.clear();
+    for (int t = 0; t <= nodes[chain[0]].g; ++t) outPath.emplace_back(sr, sc);
+    for (size_t i = 1; i < chain.size(); ++i) {
+        const Node &prev = nodes[chain[i - 1]];
+        const Node &n = nodes[chain[i]];
+        for (int t = prev.g + 1; t < n.g; ++t) outPath.emplace_back(prev.row, prev.col);
+        outPath.emplace_back(n.row, n.col);
+    }
+    return true;
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "lot_grid.hpp"
+
+// --------------------------------------------------------------------
+// DistanceField：從一個入口出發的 one-to-many Dijkstra
+//   一次搜尋就得到入口到每個可通行格的成本，不必對每個候選車位各跑一次 A*
+//   waitPenalty 時走進格子多付 max(waitTime - g, 0) (與改良 A* 相同)，所以其他車的終點等待也算進去
+//   parent 與確定的順序一起留下，assignWave 用來算「有幾個候選車位的路線經過這一格」
+// --------------------------------------------------------------------
+class DistanceField {
+public:
+    static constexpr int UNREACHED = INT_MAX;
+
+    void build(const LotGrid &grid, int passClass, int sr, int sc, bool waitPenalty) {
+        nCols = grid.cols();
+        size_t n = (size_t)grid.rows() * nCols;
+        distance.assign(n, UNREACHED);
+        parentOf.assign(n, -1);
+        done.assign(n, 0);
+        settled.clear();
+
+        using Item = std::pair<int, int>; // (g, 格子)
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+        int s = grid.index(sr, sc);
+        distance[s] = 0;
+        open.emplace(0, s);
+        static const int DR[4] = {-1, 1, 0, 0};
+        static const int DC[4] = {0, 0, -1, 1};
+        while (!open.empty()) {
+            int cell = open.top().second;
+            open.pop();
+            if (done[cell]) continue; // 已用較小 g 確定過
+            done[cell] = 1;
+            settled.push_back(cell);
+            int g = distance[cell];
+            int r = cell / nCols, c = cell % nCols;
+            uint32_t mask = grid.neighborMask(passClass, r, c);
+            for (int i = 0; i < 4; ++i) {
+                if (!(mask & (1u << i))) continue;
+                int nr = r + DR[i], nc = c + DC[i];
+                int ng = g + 1;
+                if (waitPenalty) ng += std::max(grid.waitTime(nr, nc) - ng, 0);
+                int nCell = nr * nCols + nc;
+                if (ng < distance[nCell]) {
+                    distance[nCell] = ng;
+                    parentOf[nCell] = cell;
+                    open.emplace(ng, nCell);
+                }
+            }
+        }
+    }
+
+    int dist(int r, int c) const { return distance[(size_t)r * nCols + c]; }
+    int parent(int cell) const { return parentOf[cell]; }
+    int cols() const { return nCols; }
+    size_t cellCount() const { return distance.size(); }
+    // 依成本由小到大確定的格子 (倒著走 = 子樹先於 parent)
+    const std::vector<int> &order() const { return settled; }
+
+private:
+    int nCols = 0;
+    std::vector<int> distance;
+    std::vector<int> parentOf;
+    std::vector<uint8_t> done;
+    std::vector<int> settled;
+};
+
+// --------------------------------------------------------------------
+// solveAssignment：n 列 × m 行 (n <= m) 的最小成本指派 (Hungarian，O(n²m))
+//   cost[i * m + j] = 第 i 列配到第 j 行的成本；回傳每一列配到的行
+// --------------------------------------------------------------------
+inline std::vector<int> solveAssignment(const std::vector<int64_t> &cost, int n, int m) {
+    const int64_t INF = INT64_MAX / 4;
+    std::vector<int64_t> u(n + 1, 0), v(m + 1, 0), minv(m + 1);
+    std::vector<int> p(m + 1, 0), way(m + 1, 0); // p[j] = 配到第 j 行的列 (1-based，0 = 無)
+    std::vector<char> used(m + 1);
+    for (int i = 1; i <= n; ++i) {
+        p[0] = i;
+        int j0 = 0;
+        std::fill(minv.begin(), minv.end(), INF);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[j0] = 1;
+            int i0 = p[j0], j1 = 0;
+            int64_t delta = INF;
+            for (int j = 1; j <= m; ++j) {
+                if (used[j]) continue;
+                int64_t cur = cost[(size_t)(i0 - 1) * m + (j - 1)] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; ++j) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    std::vector<int> rowToCol(n, -1);
+    for (int j = 1; j <= m; ++j) {
+        if (p[j] != 0) rowToCol[p[j] - 1] = j - 1;
+    }
+    return rowToCol;
+}
+
+// 候選車位：車位本身、旁邊的通道格 (路線終點)，以及從哪一個入口 (DistanceField) 進場
+struct StallCandidate {
+    int row, col;
+    int ar, ac;
+    int field;
+};
+
+struct WaveOptions {
+    int parkTicks = 10; // 倒車時佔住通道格的 tick 數
+    int spacing = 2;    // 候選的通道格彼此 (以及與 busy) 至少相隔的 Manhattan 距離；0 = 不限制
+    int poolFactor = 4; // 候選只保留距離最小的 poolFactor × n 個
+};
+
+// --------------------------------------------------------------------
+// assignWave：一波 n 台進場車 (依抵達順序 0..n-1) 與候選車位的最小成本指派
+//   成本 = 入口到車位旁通道格的距離 (含 waitTime 懲罰)
+//        + 倒車擋路的估計：第 i 台在通道格倒車 parkTicks tick，之後的 n-1-i 台若要經過這一格就得等；
+//          經過的比例 = 其他候選車位中，路線 (DistanceField 的 parent 樹) 經過這一格的比例
+//   => 同樣距離時，先到的車停在深處、後到的車停在靠近入口處，不必從倒車中的車旁邊擠過去
+//   候選由近到遠挑，通道格與已挑的候選、busy (還在路上的車的終點) 太近的跳過：
+//   只取最近的車位會讓整波擠進同一條單線通道，從兩頭進來的車互相卡住
+//   回傳第 i 台車配到的候選編號 (可用的候選不足 n 個時，多出來的車為 -1)
+// --------------------------------------------------------------------
+inline std::vector<int> assignWave(const std::vector<StallCandidate> &cands,
+                                   const std::vector<DistanceField> &fields, int n,
+                                   const std::vector<std::pair<int, int>> &busy = {},
+                                   const WaveOptions &opt = WaveOptions()) {
+    std::vector<int> result(n > 0 ? n : 0, -1);
+    std::vector<std::pair<int, int>> pool; // (距離, 候選編號)
+    for (size_t k = 0; k < cands.size(); ++k) {
+        const StallCandidate &s = cands[k];
+        int d = fields[s.field].dist(s.ar, s.ac);
+        if (d != DistanceField::UNREACHED) pool.emplace_back(d, (int)k);
+    }
+    if (n <= 0 || pool.empty()) return result;
+    std::sort(pool.begin(), pool.end());
+    size_t keep = std::max<size_t>((size_t)n * opt.poolFactor, (size_t)n);
+    std::vector<std::pair<int, int>> taken = busy; // 已挑的通道格
+    size_t kept = 0;
+    for (size_t k = 0; k < pool.size() && kept < keep; ++k) {
+        const StallCandidate &s = cands[pool[k].second];
+        bool near = false;
+        for (auto &t : taken) {
+            if (std::abs(t.first - s.ar) + std::abs(t.second - s.ac) < opt.spacing) {
+                near = true;
+                break;
+            }
+        }
+        if (near) continue;
+        taken.emplace_back(s.ar, s.ac);
+        pool[kept++] = pool[k];
+    }
+    pool.resize(kept);
+    if (pool.empty()) return result;
+    int m = (int)pool.size();
+    int rows = std::min(n, m);
+
+    // 每個 DistanceField 的 parent 樹上，子樹內有幾個候選車位的通道格
+    std::vector<int> through(m, 0);
+    for (size_t f = 0; f < fields.size(); ++f) {
+        const DistanceField &field = fields[f];
+        std::vector<int> count(field.cellCount(), 0);
+        bool any = false;
+        for (auto &dk : pool) {
+            const StallCandidate &s = cands[dk.second];
+            if (s.field != (int)f) continue;
+            count[(size_t)s.ar * field.cols() + s.ac]++;
+            any = true;
+        }
+        if (!any) continue;
+        const std::vector<int> &order = field.order();
+        for (size_t i = order.size(); i-- > 0;) {
+            int par = field.parent(order[i]);
+            if (par >= 0) count[par] += count[order[i]];
+        }
+        for (int j = 0; j < m; ++j) {
+            const StallCandidate &s = cands[pool[j].second];
+            if (s.field == (int)f) through[j] = count[(size_t)s.ar * field.cols() + s.ac] - 1;
+        }
+    }
+
+    // 以整數計算：距離 × (m-1) + parkTicks × 之後的車數 × 經過的候選數
+    int64_t scale = m > 1 ? m - 1 : 1;
+    std::vector<int64_t> cost((size_t)rows * m);
+    for (int i = 0; i < rows; ++i) {
+        int later = n - 1 - i;
+        for (int j = 0; j < m; ++j)
+            cost[(size_t)i * m + j] = (int64_t)pool[j].first * scale + (int64_t)opt.parkTicks * later * through[j];
+    }
+    std::vector<int> col = solveAssignment(cost, rows, m);
+    for (int i = 0; i < rows; ++i) result[i] = pool[col[i]].second;
+    return result;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// CellSet：格子索引的集合，dense 陣列 + 位置表
+//   insert / erase (與最後一個交換) / contains / 第 i 個 都是 O(1)，
+//   at(rand() % size()) 即為均勻的隨機挑選
+// --------------------------------------------------------------------
+class CellSet {
+public:
+    void reset(size_t cells) {
+        items.clear();
+        slot.assign(cells, NONE);
+    }
+
+    bool contains(int idx) const { return slot[idx] != NONE; }
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    int at(size_t i) const { return items[i]; }
+
+    void insert(int idx) {
+        if (contains(idx)) return;
+        slot[idx] = (uint32_t)items.size();
+        items.push_back(idx);
+    }
+
+    void erase(int idx) {
+        if (!contains(idx)) return;
+        uint32_t i = slot[idx];
+        int last = items.back();
+        items[i] = last;
+        slot[last] = i;
+        items.pop_back();
+        slot[idx] = NONE;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    std::vector<int> items;
+    std::vector<uint32_t> slot; // 格子 -> items 中的位置
+};
+
+// --------------------------------------------------------------------
+// FreeStallIndex：空車位索引
+//   整體一份 CellSet (隨機挑選 O(1))，另外把地圖切成 BUCKET×BUCKET 的桶，每桶記下桶內的空車位；
+//   nearest() 由查詢點所在的桶一圈一圈往外找，找到 k 個且下一圈不可能更近時停止
+//   車位變成空 / 被佔用時由呼叫端 add / remove，不再每次掃整張地圖
+// --------------------------------------------------------------------
+class FreeStallIndex {
+public:
+    static constexpr int BUCKET_SHIFT = 4; // 16×16
+    static constexpr int BUCKET = 1 << BUCKET_SHIFT;
+
+    void reset(int rows, int cols) {
+        nRows = rows;
+        nCols = cols;
+        bucketRows = (rows + BUCKET - 1) >> BUCKET_SHIFT;
+        bucketCols = (cols + BUCKET - 1) >> BUCKET_SHIFT;
+        all.reset((size_t)rows * cols);
+        buckets.assign((size_t)bucketRows * bucketCols, {});
+    }
+
+    size_t size() const { return all.size(); }
+    bool empty() const { return all.empty(); }
+    bool isFree(int r, int c) const { return all.contains(r * nCols + c); }
+
+    void add(int r, int c) {
+        int idx = r * nCols + c;
+        if (all.contains(idx)) return;
+        all.insert(idx);
+        bucketOf(r, c).push_back(idx);
+    }
+
+    void remove(int r, int c) {
+        int idx = r * nCols + c;
+        if (!all.contains(idx)) return;
+        all.erase(idx);
+        std::vector<int> &b = bucketOf(r, c);
+        auto it = std::find(b.begin(), b.end(), idx); // 每桶最多 BUCKET² 格
+        *it = b.back();
+        b.pop_back();
+    }
+
+    // 第 i 個空車位 (i < size())；搭配 rand() % size() 做均勻挑選
+    std::pair<int, int> at(size_t i) const {
+        int idx = all.at(i);
+        return {idx / nCols, idx % nCols};
+    }
+
+    // 離 (r, c) 最近的 k 個空車位 (Manhattan 距離，同距離依列、行排序)
+    std::vector<std::pair<int, int>> nearest(int r, int c, size_t k) const {
+        std::vector<std::pair<int, int>> out;
+        if (k == 0 || all.empty()) return out;
+        std::vector<std::pair<int, int>> cand; // (距離, 格子)
+        int br = std::min(std::max(r, 0), nRows - 1) >> BUCKET_SHIFT;
+        int bc = std::min(std::max(c, 0), nCols - 1) >> BUCKET_SHIFT;
+        int maxRing = std::max(std::max(br, bucketRows - 1 - br), std::max(bc, bucketCols - 1 - bc));
+        for (int ring = 0; ring <= maxRing; ++ring) {
+            for (int i = br - ring; i <= br + ring; ++i) {
+                if (i < 0 || i >= bucketRows) continue;
+                bool edgeRow = (i == br - ring || i == br + ring);
+                for (int j = bc - ring; j <= bc + ring; j += edgeRow ? 1 : 2 * ring) {
+                    if (j >= 0 && j < bucketCols) {
+                        for (int idx : buckets[(size_t)i * bucketCols + j]) {
+                            int d = std::abs(idx / nCols - r) + std::abs(idx % nCols - c);
+                            cand.emplace_back(d, idx);
+                        }
+                    }
+                    if (ring == 0) break;
+                }
+            }
+            // 下一圈的格子距離至少 ring * BUCKET + 1
+            if (cand.size() >= k) {
+                std::nth_element(cand.begin(), cand.begin() + (k - 1), cand.end());
+                if (cand[k - 1].first <= ring * BUCKET) break;
+            }
+        }
+        std::sort(cand.begin(), cand.end());
+        if (cand.size() > k) cand.resize(k);
+        for (auto &dc : cand) out.emplace_back(dc.second / nCols, dc.second % nCols);
+        return out;
+    }
+
+private:
+    std::vector<int> &bucketOf(int r, int c) {
+        return buckets[(size_t)(r >> BUCKET_SHIFT) * bucketCols + (c >> BUCKET_SHIFT)];
+    }
+
+    int nRows = 0, nCols = 0;
+    int bucketRows = 0, bucketCols = 0;
+    CellSet all;
+    std::vector<std::vector<int>> buckets; // 每桶的空車位 (格子索引)
+};
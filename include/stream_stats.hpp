@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------------
+// RunningStats：單次走訪的平均 / 變異數 (Welford)，可跨執行緒 merge (Chan et al.)
+//   mean 以「總和 / 個數」計算：輸入是整數 tick 時與直接加總後相除逐位元相同
+//   M2 (與平均差的平方和) 以 Welford 的方式更新，不會有 Σx² - n·mean² 的相消誤差
+// --------------------------------------------------------------------
+class RunningStats {
+public:
+    void add(double x) {
+        if (std::isnan(x)) return;
+        double oldMean = n ? total / n : 0.0;
+        ++n;
+        total += x;
+        m2 += (x - oldMean) * (x - total / n);
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+    }
+
+    void merge(const RunningStats &o) {
+        if (o.n == 0) return;
+        if (n == 0) {
+            *this = o;
+            return;
+        }
+        double delta = o.mean() - mean();
+        uint64_t both = n + o.n;
+        m2 += o.m2 + delta * delta * ((double)n * o.n / both);
+        n = both;
+        total += o.total;
+        lo = std::min(lo, o.lo);
+        hi = std::max(hi, o.hi);
+    }
+
+    uint64_t count() const { return n; }
+    double sum() const { return total; }
+    double mean() const { return n ? total / n : std::numeric_limits<double>::quiet_NaN(); }
+    // 樣本變異數 (除以 n - 1)
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+    double min() const { return n ? lo : std::numeric_limits<double>::quiet_NaN(); }
+    double max() const { return n ? hi : std::numeric_limits<double>::quiet_NaN(); }
+
+    // 平均值 95% 信賴區間的半寬 t(0.975, n-1) × sd / √n (n < 2 時為 NaN)
+    double ci95HalfWidth() const {
+        if (n < 2) return std::numeric_limits<double>::quiet_NaN();
+        return tCritical95(n - 1) * stddev() / std::sqrt((double)n);
+    }
+
+    // 雙尾 95% 的 t 臨界值：自由度 30 以內查表，之後用 Cornish-Fisher 展開 (誤差 < 1e-3)
+    static double tCritical95(uint64_t df) {
+        static const double TABLE[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                         2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                         2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        if (df == 0) return std::numeric_limits<double>::quiet_NaN();
+        if (df <= 30) return TABLE[df - 1];
+        const double z = 1.959963984540054;
+        double d = (double)df, z3 = z * z * z, z5 = z3 * z * z;
+        return z + (z3 + z) / (4 * d) + (5 * z5 + 16 * z3 + 3 * z) / (96 * d * d);
+    }
+
+private:
+    uint64_t n = 0;
+    double total = 0.0;
+    double m2 = 0.0;
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+};
+
+// --------------------------------------------------------------------
+// QuantileHistogram：HDR histogram 式的 log-linear 桶，用來估計百分位數
+//   每個 2 的冪次區間再切成 2^SUB_BITS 個等寬子桶 => 桶寬不超過值的 2^-SUB_BITS (約 0.025%)；
+//   正負值各自分桶，只保留有資料的桶 (hash map，add 為 O(1))；查詢時才依值排序一次並留著，下次 add 後重排
+//   每個桶記下個數與桶內的最小、最大值：tick 與 front/back 平均這類離散值一桶通常只有一個值，
+//   此時 percentile() 與排序後直接取值完全相同
+//   merge 只是各桶相加，結果與 merge 的順序 (執行緒數、完成順序) 無關
+//   add / merge / 查詢都不是 thread-safe：每個執行緒各用一份，最後再 merge
+// --------------------------------------------------------------------
+class QuantileHistogram {
+public:
+    static constexpr int SUB_BITS = 12;
+
+    void add(double x) {
+        if (std::isnan(x)) return;
+        Bucket &b = buckets[keyOf(x)];
+        if (b.count == 0) {
+            b.lo = b.hi = x;
+        } else {
+            b.lo = std::min(b.lo, x);
+            b.hi = std::max(b.hi, x);
+        }
+        ++b.count;
+        ++n;
+        sortedValid = false;
+    }
+
+    void merge(const QuantileHistogram &o) {
+        for (auto &kv : o.buckets) {
+            Bucket &b = buckets[kv.first];
+            if (b.count == 0) {
+                b = kv.second;
+            } else {
+                b.count += kv.second.count;
+                b.lo = std::min(b.lo, kv.second.lo);
+                b.hi = std::max(b.hi, kv.second.hi);
+            }
+        }
+        n += o.n;
+        sortedValid = false;
+    }
+
+    uint64_t count() const { return n; }
+    size_t bucketCount() const { return buckets.size(); }
+
+    // q 為 0..100；與 scripts/plot_results.py 的 percentile() 相同：
+    //   pos = (n - 1) × q / 100，取第 floor(pos)、ceil(pos) 小的值線性內插
+    double percentile(double q) const {
+        if (n == 0) return std::numeric_limits<double>::quiet_NaN();
+        const std::vector<Entry> &s = sortedBuckets();
+        if (q <= 0) return s.front().second.lo;
+        if (q >= 100) return s.back().second.hi;
+        double pos = (double)(n - 1) * q / 100.0;
+        uint64_t lower = (uint64_t)std::floor(pos), upper = (uint64_t)std::ceil(pos);
+        double lv = valueAt(s, lower);
+        if (lower == upper) return lv;
+        return lv + (valueAt(s, upper) - lv) * (pos - (double)lower);
+    }
+
+private:
+    struct Bucket {
+        uint64_t count = 0;
+        double lo = 0.0, hi = 0.0;
+    };
+    using Entry = std::pair<int64_t, Bucket>;
+
+    // 0 => 0；|x| = m × 2^e (m 在 [0.5, 1)) => (e, m 的前 SUB_BITS 位)；負值取反，鍵的順序即值的順序
+    static int64_t keyOf(double x) {
+        if (x == 0.0) return 0;
+        int e;
+        double m = std::frexp(std::fabs(x), &e);
+        int64_t sub = (int64_t)((m * 2.0 - 1.0) * (double)(1 << SUB_BITS));
+        int64_t key = ((int64_t)(e + 1100) << SUB_BITS) + sub + 1;
+        return x < 0 ? -key : key;
+    }
+
+    // 第 rank 小 (0-based) 的值：桶內有多個值時在最小、最大值之間依名次內插
+    static double valueAt(const std::vector<Entry> &s, uint64_t rank) {
+        for (auto &kv : s) {
+            const Bucket &b = kv.second;
+            if (rank < b.count) {
+                if (b.count == 1) return b.lo;
+                return b.lo + (b.hi - b.lo) * (double)rank / (double)(b.count - 1);
+            }
+            rank -= b.count;
+        }
+        return s.back().second.hi;
+    }
+
+    const std::vector<Entry> &sortedBuckets() const {
+        if (!sortedValid) {
+            sorted.assign(buckets.begin(), buckets.end());
+            std::sort(sorted.begin(), sorted.end(),
+                      [](const Entry &a, const Entry &b) { return a.first < b.first; });
+            sortedValid = true;
+        }
+        return sorted;
+    }
+
+    std::unordered_map<int64_t, Bucket> buckets;
+    uint64_t n = 0;
+    mutable std::vector<Entry> sorted; // 依鍵 (= 值) 排序的 buckets
+    mutable bool sortedValid = false;
+};
+
+// --------------------------------------------------------------------
+// StreamSummary：一個欄位的 RunningStats + QuantileHistogram
+// --------------------------------------------------------------------
+struct StreamSummary {
+    RunningStats stats;
+    QuantileHistogram hist;
+
+    void add(double x) {
+        stats.add(x);
+        hist.add(x);
+    }
+    void merge(const StreamSummary &o) {
+        stats.merge(o.stats);
+        hist.merge(o.hist);
+    }
+};
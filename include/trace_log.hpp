@@ -0,0 +1,576 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "lot_grid.hpp"
+#include "mapped_file.hpp"
+#include "vehicle_table.hpp"
+
+// --------------------------------------------------------------------
+// 模擬軌跡 (--trace)：每個 tick 的車輛位置、格子 (type / waitTime) 的變化、封閉與重規劃事件
+//
+// 檔案格式 (little-endian，整數多半是 varint)：
+//   header 32 bytes：magic "PKTR"、version、rows、cols、keyframe 間隔 K (tick)、各 type 的顯示字元 [8]
+//   之後依序是區塊，第一個 byte 為種類：
+//     'K' keyframe：上一筆 tick 紀錄的 tick、type 平面 (run-length)、非 0 的 waitTime、行駛中的車輛位置
+//     'T' tick：與上一筆的 tick 差、變動的格子 (格子編號差 + type + waitTime 差)、
+//              位置變動的車輛 (ID 差 + 格子差，0 = 離開)、事件
+//     'I' keyframe 索引：第 k 格 = 「tick k·K 之前」狀態的 keyframe 位置
+//   最後 40 bytes 為 trailer：索引位置、索引格數、最後的 tick、tick 紀錄數、magic "PKTE"
+//   跳到 tick T：索引第 T / K 格 => keyframe，之後最多重播 K 個 tick 的紀錄 (O(1) 定位)
+//
+// TraceWriter：只在 tick 結束時 (SimClock 的 tick observer) 寫一筆紀錄
+//   格子變化由 LotGrid 的變更記錄提供 (只看這個 tick 寫過的格子，不掃整張地圖)，
+//   車輛位置由模擬端在移動時呼叫 vehicleAt / vehicleGone；輸出先寫進 buffer，滿 1 MB 才寫檔
+// TraceReader：mmap 整個檔案 (Windows 讀進記憶體)，seek / replay 都直接在 buffer 上解碼
+// --------------------------------------------------------------------
+enum class TraceEvent : uint8_t {
+    Close = 1,  // a = 格子
+    Reopen = 2, // a = 格子
+    Replan = 3, // a = 車輛，b = 新路線長度 (0 = 找不到)
+    Arrive = 4, // a = 車輛，b = 這一段行駛的 tick 數
+};
+
+struct TraceEventRecord {
+    TraceEvent kind;
+    uint32_t a, b;
+};
+
+namespace trace_format {
+static constexpr char MAGIC[4] = {'P', 'K', 'T', 'R'};
+static constexpr char TRAILER_MAGIC[4] = {'P', 'K', 'T', 'E'};
+static constexpr uint32_t VERSION = 1;
+static constexpr size_t HEADER_SIZE = 32;
+static constexpr size_t TRAILER_SIZE = 40;
+static constexpr int GLYPHS = 8;
+
+inline void putVarint(std::string &out, uint64_t v) {
+    while (v >= 0x80) {
+        out += (char)(uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out += (char)(uint8_t)v;
+}
+inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+template <class T>
+inline void putRaw(std::string &out, T v) {
+    char b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));
+    out.append(b, sizeof(T));
+}
+
+// 從 buffer 依序讀出；越界時 ok 變成 false (之後都回傳 0)
+struct Cursor {
+    const uint8_t *p, *end;
+    bool ok = true;
+
+    uint8_t byte() {
+        if (p >= end) return fail();
+        return *p++;
+    }
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) return fail();
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        return fail();
+    }
+    uint8_t fail() {
+        ok = false;
+        p = end;
+        return 0;
+    }
+};
+} // namespace trace_format
+
+class TraceWriter {
+public:
+    TraceWriter() = default;
+    ~TraceWriter() { close(); }
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    // glyphs[t] = type t 在重播時顯示的字元 (最多 8 種)；目前的地圖為起始狀態
+    bool open(const std::string &path, LotGrid &g, const std::string &glyphs, int keyframeTicks = 64) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        grid = &g;
+        every = keyframeTicks > 0 ? keyframeTicks : 64;
+        size_t cells = (size_t)g.rows() * g.cols();
+        types.resize(cells);
+        waits.resize(cells);
+        for (int r = 0; r < g.rows(); ++r) {
+            for (int c = 0; c < g.cols(); ++c) {
+                types[g.index(r, c)] = g.type(r, c);
+                waits[g.index(r, c)] = g.waitTime(r, c);
+            }
+        }
+        cellMark.assign(cells, 0);
+        changeLog.clear();
+        g.setChangeLog(&changeLog);
+        vehicleCell.clear();
+        recordedCell.clear();
+        vehicleMark.clear();
+        dirtyVehicles.clear();
+        events.clear();
+        index.clear();
+        buf.clear();
+        flushed = 0;
+        lastTick = 0;
+        tickRecords = 0;
+        keyframes = 0;
+        nanos = 0;
+
+        buf.append(trace_format::MAGIC, 4);
+        trace_format::putRaw<uint32_t>(buf, trace_format::VERSION);
+        trace_format::putRaw<uint32_t>(buf, (uint32_t)g.rows());
+        trace_format::putRaw<uint32_t>(buf, (uint32_t)g.cols());
+        trace_format::putRaw<uint32_t>(buf, (uint32_t)every);
+        char glyph[trace_format::GLYPHS];
+        for (int t = 0; t < trace_format::GLYPHS; ++t) glyph[t] = t < (int)glyphs.size() ? glyphs[t] : '?';
+        buf.append(glyph, trace_format::GLYPHS);
+        trace_format::putRaw<uint32_t>(buf, 0);
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    // 車輛在 tick 內移到 (r, c) / 離開 (停好或中斷)；同一個 tick 內以最後的位置為準
+    void vehicleAt(VehicleId id, int r, int c) { setVehicle(id, (uint32_t)grid->index(r, c) + 1); }
+    void vehicleGone(VehicleId id) { setVehicle(id, 0); }
+
+    void event(TraceEvent kind, uint32_t a, uint32_t b = 0) { events.push_back(TraceEventRecord{kind, a, b}); }
+
+    // tick 結束：寫出這個 tick 的變化 (沒有任何變化時不寫)
+    void endTick(long long tick) {
+        if (!file) return;
+        auto t0 = std::chrono::steady_clock::now();
+        cells.clear();
+        for (int cell : changeLog) {
+            if (cellMark[cell]) continue;
+            cellMark[cell] = 1;
+            cells.push_back(cell);
+        }
+        changeLog.clear();
+        std::sort(cells.begin(), cells.end());
+        std::sort(dirtyVehicles.begin(), dirtyVehicles.end());
+
+        size_t nCells = 0, nVehicles = 0;
+        for (int cell : cells) {
+            if (grid->type(cell / grid->cols(), cell % grid->cols()) != types[cell] ||
+                grid->waitTime(cell / grid->cols(), cell % grid->cols()) != waits[cell])
+                cells[nCells++] = cell;
+            else
+                cellMark[cell] = 0;
+        }
+        cells.resize(nCells);
+        for (VehicleId id : dirtyVehicles) {
+            if (vehicleCell[id] != recordedCell[id]) dirtyVehicles[nVehicles++] = id;
+            else vehicleMark[id] = 0;
+        }
+        dirtyVehicles.resize(nVehicles);
+
+        if (!cells.empty() || !dirtyVehicles.empty() || !events.empty()) {
+            long long slot = tick / every;
+            if ((long long)index.size() <= slot) {
+                uint64_t at = position();
+                writeKeyframe();
+                while ((long long)index.size() <= slot) index.push_back(at);
+            }
+            writeTick(tick);
+        }
+        for (int cell : cells) cellMark[cell] = 0;
+        for (VehicleId id : dirtyVehicles) vehicleMark[id] = 0;
+        dirtyVehicles.clear();
+        events.clear();
+        if (buf.size() >= (1u << 20)) flush();
+        nanos += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - t0)
+                     .count();
+    }
+
+    // 寫出索引與 trailer 並關檔
+    bool close() {
+        if (!file) return true;
+        if (index.empty()) {
+            index.push_back(position());
+            writeKeyframe();
+        }
+        uint64_t indexAt = position();
+        buf += 'I';
+        for (uint64_t off : index) trace_format::putRaw<uint64_t>(buf, off);
+        trace_format::putRaw<uint64_t>(buf, indexAt);
+        trace_format::putRaw<uint64_t>(buf, (uint64_t)index.size());
+        trace_format::putRaw<uint64_t>(buf, (uint64_t)lastTick);
+        trace_format::putRaw<uint64_t>(buf, tickRecords);
+        buf.append(trace_format::TRAILER_MAGIC, 4);
+        trace_format::putRaw<uint32_t>(buf, 0);
+        flush();
+        bool ok = std::fclose(file) == 0 && !failed;
+        file = nullptr;
+        if (grid) grid->setChangeLog(nullptr);
+        grid = nullptr;
+        return ok;
+    }
+
+    uint64_t bytesWritten() const { return flushed + buf.size(); }
+    uint64_t ticksRecorded() const { return tickRecords; }
+    size_t keyframeCount() const { return keyframes; }
+    double recordMillis() const { return nanos / 1e6; }
+
+private:
+    void setVehicle(VehicleId id, uint32_t cell) {
+        if (!file) return;
+        if (id >= vehicleCell.size()) {
+            vehicleCell.resize((size_t)id + 1, 0);
+            recordedCell.resize((size_t)id + 1, 0);
+            vehicleMark.resize((size_t)id + 1, 0);
+        }
+        vehicleCell[id] = cell;
+        if (!vehicleMark[id]) {
+            vehicleMark[id] = 1;
+            dirtyVehicles.push_back(id);
+        }
+    }
+
+    uint64_t position() const { return flushed + buf.size(); }
+
+    // 目前「已記錄」的狀態 (types / waits / recordedCell)
+    void writeKeyframe() {
+        ++keyframes;
+        buf += 'K';
+        trace_format::putVarint(buf, (uint64_t)lastTick);
+        for (size_t i = 0; i < types.size();) {
+            size_t j = i;
+            while (j < types.size() && types[j] == types[i]) ++j;
+            trace_format::putVarint(buf, j - i);
+            buf += (char)types[i];
+            i = j;
+        }
+        size_t nonZero = 0;
+        for (int w : waits) nonZero += w != 0;
+        trace_format::putVarint(buf, nonZero);
+        size_t prev = 0;
+        for (size_t i = 0; i < waits.size(); ++i) {
+            if (waits[i] == 0) continue;
+            trace_format::putVarint(buf, i - prev);
+            trace_format::putVarint(buf, trace_format::zigzag(waits[i]));
+            prev = i;
+        }
+        size_t present = 0;
+        for (uint32_t cell : recordedCell) present += cell != 0;
+        trace_format::putVarint(buf, present);
+        VehicleId prevId = 0;
+        for (VehicleId id = 0; id < recordedCell.size(); ++id) {
+            if (!recordedCell[id]) continue;
+            trace_format::putVarint(buf, id - prevId);
+            trace_format::putVarint(buf, recordedCell[id] - 1);
+            prevId = id;
+        }
+    }
+
+    void writeTick(long long tick) {
+        buf += 'T';
+        trace_format::putVarint(buf, (uint64_t)(tick - lastTick));
+        lastTick = tick;
+        ++tickRecords;
+
+        trace_format::putVarint(buf, cells.size());
+        int prevCell = 0;
+        for (int cell : cells) {
+            int r = cell / grid->cols(), c = cell % grid->cols();
+            uint8_t t = grid->type(r, c);
+            int w = grid->waitTime(r, c);
+            trace_format::putVarint(buf, (uint64_t)(cell - prevCell));
+            buf += (char)t;
+            trace_format::putVarint(buf, trace_format::zigzag((int64_t)w - waits[cell]));
+            types[cell] = t;
+            waits[cell] = w;
+            prevCell = cell;
+        }
+
+        trace_format::putVarint(buf, dirtyVehicles.size());
+        VehicleId prevId = 0;
+        for (VehicleId id : dirtyVehicles) {
+            uint32_t cell = vehicleCell[id];
+            trace_format::putVarint(buf, id - prevId);
+            // 0 = 離開；否則 = zigzag(格子差) + 1 (不在場的車以格子 0 為基準)
+            int64_t from = recordedCell[id] ? (int64_t)recordedCell[id] - 1 : 0;
+            trace_format::putVarint(buf, cell ? trace_format::zigzag((int64_t)cell - 1 - from) + 1 : 0);
+            recordedCell[id] = cell;
+            prevId = id;
+        }
+
+        trace_format::putVarint(buf, events.size());
+        for (const TraceEventRecord &e : events) {
+            buf += (char)e.kind;
+            trace_format::putVarint(buf, e.a);
+            trace_format::putVarint(buf, e.b);
+        }
+    }
+
+    void flush() {
+        if (!file || buf.empty()) return;
+        if (std::fwrite(buf.data(), 1, buf.size(), file) != buf.size()) failed = true;
+        flushed += buf.size();
+        buf.clear();
+    }
+
+    std::FILE *file = nullptr;
+    bool failed = false;
+    LotGrid *grid = nullptr;
+    int every = 64;
+    // 已寫進檔案的狀態
+    std::vector<uint8_t> types;
+    std::vector<int> waits;
+    std::vector<uint32_t> recordedCell; // 車輛 -> 格子 + 1 (0 = 不在場)
+    // 這個 tick 的變化
+    std::vector<int> changeLog; // LotGrid 寫入過的格子 (可重複)
+    std::vector<uint8_t> cellMark;
+    std::vector<int> cells;
+    std::vector<uint32_t> vehicleCell;
+    std::vector<uint8_t> vehicleMark;
+    std::vector<VehicleId> dirtyVehicles;
+    std::vector<TraceEventRecord> events;
+    std::vector<uint64_t> index; // keyframe 索引
+    std::string buf;
+    uint64_t flushed = 0;
+    long long lastTick = 0;
+    uint64_t tickRecords = 0;
+    size_t keyframes = 0;
+    uint64_t nanos = 0;
+};
+
+// 重播時的狀態：格子 type / waitTime，車輛位置 (格子 + 1，0 = 不在場)
+struct TraceState {
+    long long tick = -1; // 最後套用的 tick 紀錄 (-1 = 起始狀態)
+    std::vector<uint8_t> type;
+    std::vector<int> wait;
+    std::vector<uint32_t> vehicleCell;
+};
+
+// 一筆 tick 紀錄的內容 (replay 時提供給呼叫端)
+struct TraceTick {
+    long long tick = 0;
+    std::vector<int> cells;          // 變動的格子
+    std::vector<VehicleId> vehicles; // 位置變動的車輛
+    std::vector<TraceEventRecord> events;
+};
+
+class TraceReader {
+public:
+    TraceReader() = default;
+    ~TraceReader() { unmap(); }
+    TraceReader(const TraceReader &) = delete;
+    TraceReader &operator=(const TraceReader &) = delete;
+
+    bool open(const std::string &path, std::string &err) {
+        unmap();
+        if (!map(path, err)) return false;
+        if (size < trace_format::HEADER_SIZE + trace_format::TRAILER_SIZE ||
+            std::memcmp(data, trace_format::MAGIC, 4) != 0) {
+            err = "not a trace file";
+            return false;
+        }
+        if (read<uint32_t>(4) != trace_format::VERSION) {
+            err = "unsupported trace version";
+            return false;
+        }
+        nRows = (int)read<uint32_t>(8);
+        nCols = (int)read<uint32_t>(12);
+        every = (int)read<uint32_t>(16);
+        std::memcpy(glyphs, data + 20, trace_format::GLYPHS);
+        size_t t = size - trace_format::TRAILER_SIZE;
+        if (std::memcmp(data + t + 32, trace_format::TRAILER_MAGIC, 4) != 0) {
+            err = "trace was not closed (missing index)";
+            return false;
+        }
+        indexAt = read<uint64_t>(t);
+        slots = read<uint64_t>(t + 8);
+        last = (long long)read<uint64_t>(t + 16);
+        records = read<uint64_t>(t + 24);
+        if (indexAt + 1 + slots * 8 != t || data[indexAt] != 'I' || slots == 0) {
+            err = "corrupt keyframe index";
+            return false;
+        }
+        return true;
+    }
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    int keyframeTicks() const { return every; }
+    long long lastTick() const { return last; }
+    uint64_t tickRecords() const { return records; }
+    size_t fileSize() const { return size; }
+    size_t slotCount() const { return (size_t)slots; }
+    char glyph(uint8_t type) const { return type < trace_format::GLYPHS ? glyphs[type] : '?'; }
+
+    // 不同的 keyframe 個數 (沒有紀錄的區間共用下一個 keyframe)
+    size_t keyframeCount() const {
+        size_t n = 0;
+        for (size_t k = 0; k < slots; ++k)
+            if (k == 0 || slotOffset(k) != slotOffset(k - 1)) ++n;
+        return n;
+    }
+
+    // tick 結束時的狀態 (tick < 0 => 起始狀態)：索引定位 keyframe，再重播同一區間內的紀錄
+    //   last 不為 null 時留下最後套用的那筆紀錄 (沒有套用任何紀錄時 tick = -1)
+    bool seek(long long tick, TraceState &s, TraceTick *last = nullptr) const {
+        size_t k = tick < 0 ? 0 : (size_t)std::min<long long>(tick / every, (long long)slots - 1);
+        trace_format::Cursor cur{data + slotOffset(k), data + indexAt};
+        long long base = 0;
+        if (!readKeyframe(cur, s, base)) return false;
+        TraceTick scratch;
+        TraceTick &tk = last ? *last : scratch;
+        tk = TraceTick();
+        tk.tick = -1;
+        while (cur.ok && cur.p < cur.end && *cur.p == 'T') {
+            trace_format::Cursor peek = cur;
+            peek.byte();
+            if (base + (long long)peek.varint() > tick) break;
+            if (!readTick(cur, s, base, tk)) return false;
+        }
+        return cur.ok;
+    }
+
+    // 從頭依序重播每一筆 tick 紀錄：f(const TraceTick &, const TraceState &套用後的狀態)
+    template <class F>
+    bool replay(F f) const {
+        TraceState s;
+        trace_format::Cursor cur{data + trace_format::HEADER_SIZE, data + indexAt};
+        long long base = 0;
+        TraceTick tk;
+        while (cur.ok && cur.p < cur.end) {
+            if (*cur.p == 'K') {
+                if (!readKeyframe(cur, s, base)) return false;
+            } else if (*cur.p == 'T') {
+                if (!readTick(cur, s, base, tk)) return false;
+                f(tk, s);
+            } else {
+                return false;
+            }
+        }
+        return cur.ok;
+    }
+
+private:
+    template <class T>
+    T read(size_t at) const {
+        T v;
+        std::memcpy(&v, data + at, sizeof(T));
+        return v;
+    }
+    uint64_t slotOffset(size_t k) const { return read<uint64_t>(indexAt + 1 + k * 8); }
+
+    bool readKeyframe(trace_format::Cursor &cur, TraceState &s, long long &base) const {
+        if (cur.byte() != 'K') return false;
+        size_t cells = (size_t)nRows * nCols;
+        base = (long long)cur.varint();
+        s.tick = base;
+        s.type.resize(cells);
+        s.wait.assign(cells, 0);
+        for (size_t i = 0; i < cells && cur.ok;) {
+            size_t run = (size_t)cur.varint();
+            uint8_t t = cur.byte();
+            if (run == 0 || i + run > cells) return false;
+            std::fill(s.type.begin() + i, s.type.begin() + i + run, t);
+            i += run;
+        }
+        size_t waits = (size_t)cur.varint();
+        size_t cell = 0;
+        for (size_t i = 0; i < waits && cur.ok; ++i) {
+            cell += (size_t)cur.varint();
+            if (cell >= cells) return false;
+            s.wait[cell] = (int)trace_format::unzigzag(cur.varint());
+        }
+        std::fill(s.vehicleCell.begin(), s.vehicleCell.end(), 0);
+        size_t present = (size_t)cur.varint();
+        VehicleId id = 0;
+        for (size_t i = 0; i < present && cur.ok; ++i) {
+            id += (VehicleId)cur.varint();
+            uint32_t at = (uint32_t)cur.varint();
+            if (at >= cells) return false;
+            if (id >= s.vehicleCell.size()) s.vehicleCell.resize((size_t)id + 1, 0);
+            s.vehicleCell[id] = at + 1;
+        }
+        return cur.ok;
+    }
+
+    bool readTick(trace_format::Cursor &cur, TraceState &s, long long &base, TraceTick &tk) const {
+        if (cur.byte() != 'T') return false;
+        size_t cells = (size_t)nRows * nCols;
+        base += (long long)cur.varint();
+        s.tick = tk.tick = base;
+        tk.cells.clear();
+        tk.vehicles.clear();
+        tk.events.clear();
+
+        size_t n = (size_t)cur.varint();
+        size_t cell = 0;
+        for (size_t i = 0; i < n && cur.ok; ++i) {
+            cell += (size_t)cur.varint();
+            if (cell >= cells) return false;
+            s.type[cell] = cur.byte();
+            s.wait[cell] += (int)trace_format::unzigzag(cur.varint());
+            tk.cells.push_back((int)cell);
+        }
+        n = (size_t)cur.varint();
+        VehicleId id = 0;
+        for (size_t i = 0; i < n && cur.ok; ++i) {
+            id += (VehicleId)cur.varint();
+            uint64_t code = cur.varint();
+            if (id >= s.vehicleCell.size()) s.vehicleCell.resize((size_t)id + 1, 0);
+            if (code == 0) {
+                s.vehicleCell[id] = 0;
+            } else {
+                int64_t from = s.vehicleCell[id] ? (int64_t)s.vehicleCell[id] - 1 : 0;
+                int64_t at = from + trace_format::unzigzag(code - 1);
+                if (at < 0 || (size_t)at >= cells) return false;
+                s.vehicleCell[id] = (uint32_t)at + 1;
+            }
+            tk.vehicles.push_back(id);
+        }
+        n = (size_t)cur.varint();
+        for (size_t i = 0; i < n && cur.ok; ++i) {
+            TraceEventRecord e;
+            e.kind = (TraceEvent)cur.byte();
+            e.a = (uint32_t)cur.varint();
+            e.b = (uint32_t)cur.varint();
+            tk.events.push_back(e);
+        }
+        return cur.ok;
+    }
+
+    bool map(const std::string &path, std::string &err) {
+        if (!file.open(path, err)) return false;
+        data = file.data();
+        size = file.size();
+        return true;
+    }
+
+    void unmap() {
+        file.close();
+        data = nullptr;
+        size = 0;
+    }
+
+    MappedFile file;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    int nRows = 0, nCols = 0, every = 64;
+    char glyphs[trace_format::GLYPHS] = {};
+    uint64_t indexAt = 0, slots = 0, records = 0;
+    long long last = 0;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------------------
+// 車輛 ID 與車輛表
+//   VehicleId 為 32-bit，從 1 開始連號 (0 = 沒有車)，地圖平面只存 ID
+//   VehicleTable 以 ID 直接索引 (dense vector)，熱路徑上不需要 map 查詢
+//   原本以字母大小寫區分進場 / 離場，改由 VehicleRole 表示；字母只用在顯示
+// --------------------------------------------------------------------
+using VehicleId = uint32_t;
+static constexpr VehicleId NO_VEHICLE = 0;
+
+enum class VehicleRole : uint8_t { Arriving, Departing };
+
+// 顯示用字元：進場大寫、離場小寫，超過 26 台時循環使用
+inline char vehicleGlyph(VehicleId id, VehicleRole role) {
+    if (id == NO_VEHICLE) return ' ';
+    char base = role == VehicleRole::Arriving ? 'A' : 'a';
+    return (char)(base + (id - 1) % 26);
+}
+
+// 輸出用名稱：有字母標籤 (原本的 char ID) 就用字母，否則用 V<id>
+inline std::string vehicleName(VehicleId id, char label) {
+    if (label != '\0') return std::string(1, label);
+    return "V" + std::to_string(id);
+}
+
+template <class Record>
+class VehicleTable {
+public:
+    // 新增一台車，回傳它的 ID
+    VehicleId add(Record rec) {
+        records.push_back(std::move(rec));
+        return (VehicleId)records.size();
+    }
+
+    bool contains(VehicleId id) const { return id != NO_VEHICLE && id <= records.size(); }
+
+    Record &operator[](VehicleId id) { return records[id - 1]; }
+    const Record &operator[](VehicleId id) const { return records[id - 1]; }
+
+    size_t size() const { return records.size(); }
+    void reserve(size_t n) { records.reserve(n); }
+    void clear() { records.clear(); }
+
+    template <class F>
+    void forEach(F f) {
+        for (size_t i = 0; i < records.size(); ++i) f((VehicleId)(i + 1), records[i]);
+    }
+
+private:
+    std::vector<Record> records;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------
+// WorkStealingPool：固定數量 worker，每個 worker 有自己的 deque
+//   worker 從自己的尾端拿工作，沒工作時從別人的前端偷
+//   外部 submit 輪流分配到各 worker；worker 內部 submit 則放進自己的 deque
+// --------------------------------------------------------------------
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency()) {
+        if (threads == 0) threads = 1;
+        for (unsigned i = 0; i < threads; ++i) queues.emplace_back(new Queue());
+        for (unsigned i = 0; i < threads; ++i) workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    ~WorkStealingPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lk(sleepMtx);
+            stopping = true;
+        }
+        sleepCv.notify_all();
+        for (auto &w : workers) w.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    unsigned size() const { return (unsigned)workers.size(); }
+
+    void submit(Task task) {
+        unsigned target = (currentPool() == this && currentWorker() >= 0)
+                              ? (unsigned)currentWorker()
+                              : roundRobin.fetch_add(1, std::memory_order_relaxed) % size();
+        pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lk(sleepMtx);
+            queued++; // 先計數再放入，worker 的 queued-- 一定在這之後
+        }
+        {
+            std::lock_guard<std::mutex> lk(queues[target]->m);
+            queues[target]->q.push_back(std::move(task));
+        }
+        sleepCv.notify_one();
+    }
+
+    // 等待目前所有已送出的工作完成 (不可在 worker 內呼叫)
+    void wait() {
+        std::unique_lock<std::mutex> lk(sleepMtx);
+        doneCv.wait(lk, [this]() { return pending.load() == 0; });
+    }
+
+    uint64_t stolenTasks() const { return stolen.load(); }
+
+    // 目前執行緒在所屬 pool 中的 worker 編號 (0..size()-1)；不是 worker 時為 -1
+    //   用來讓每個 worker 各自累計資料，最後再合併
+    static int workerIndex() { return currentWorker(); }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> q;
+    };
+
+    static const WorkStealingPool *&currentPool() {
+        thread_local const WorkStealingPool *pool = nullptr;
+        return pool;
+    }
+    static int &currentWorker() {
+        thread_local int idx = -1;
+        return idx;
+    }
+
+    bool tryPop(unsigned self, Task &out) {
+        {
+            std::lock_guard<std::mutex> lk(queues[self]->m);
+            if (!queues[self]->q.empty()) {
+                out = std::move(queues[self]->q.back());
+                queues[self]->q.pop_back();
+                return true;
+            }
+        }
+        for (unsigned k = 1; k < size(); ++k) {
+            Queue &victim = *queues[(self + k) % size()];
+            std::lock_guard<std::mutex> lk(victim.m);
+            if (!victim.q.empty()) {
+                out = std::move(victim.q.front());
+                victim.q.pop_front();
+                stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned self) {
+        currentPool() = this;
+        currentWorker() = (int)self;
+        for (;;) {
+            Task task;
+            if (tryPop(self, task)) {
+                {
+                    std::lock_guard<std::mutex> lk(sleepMtx);
+                    queued--;
+                }
+                task();
+                if (pending.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lk(sleepMtx);
+                    doneCv.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lk(sleepMtx);
+            sleepCv.wait(lk, [this]() { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending{0};
+    std::atomic<unsigned> roundRobin{0};
+    std::atomic<uint64_t> stolen{0};
+    size_t queued = 0; // 受 sleepMtx 保護
+    bool stopping = false;
+    std::mutex sleepMtx;
+    std::condition_variable sleepCv;
+    std::condition_variable doneCv;
+};
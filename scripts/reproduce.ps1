@@ -23,7 +23,16 @@ if (Test-Path ("$statExe.exe")) {
     $statExe = "$statExe.exe"
 }
 
+$reportExe = Join-Path $buildDir "results_report"
+if (Test-Path ("$reportExe.exe")) {
+    $reportExe = "$reportExe.exe"
+}
+
 & $repathExe
 & $statExe
 
-python $plotScript --input $resultCsv --output (Join-Path $rootDir "docs/figs")
+if (Test-Path $reportExe) {
+    & $reportExe --input $resultCsv --output (Join-Path $rootDir "docs/figs")
+} else {
+    python $plotScript --input $resultCsv --output (Join-Path $rootDir "docs/figs")
+}
@@ -12,6 +12,7 @@ cmake --build "${BUILD_DIR}" --config Release
 
 REPATH_EXE="${BUILD_DIR}/250919repath"
 STAT_EXE="${BUILD_DIR}/250604statisticlog"
+REPORT_EXE="${BUILD_DIR}/results_report"
 
 if [[ -x "${REPATH_EXE}" ]]; then
     "${REPATH_EXE}"
@@ -31,4 +32,10 @@ else
     exit 1
 fi
 
-python "${PLOT_SCRIPT}" --input "${RESULT_CSV}" --output "${ROOT_DIR}/docs/figs"
+if [[ -x "${REPORT_EXE}" ]]; then
+    "${REPORT_EXE}" --input "${RESULT_CSV}" --output "${ROOT_DIR}/docs/figs"
+elif [[ -x "${REPORT_EXE}.exe" ]]; then
+    "${REPORT_EXE}.exe" --input "${RESULT_CSV}" --output "${ROOT_DIR}/docs/figs"
+else
+    python "${PLOT_SCRIPT}" --input "${RESULT_CSV}" --output "${ROOT_DIR}/docs/figs"
+fi
@@ -14,14 +14,36 @@
 #include <fstream>
 #include <algorithm> // for std::shuffle
 #include <random>    // for std::default_random_engine
+#include <charconv>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "cell_occupancy.hpp"
+#include "grid_astar.hpp"
+#include "landmarks.hpp"
+#include "lot_grid.hpp"
+#include "lot_layout.hpp"
+#include "lot_renderer.hpp"
+#include "node_pool.hpp"
+#include "path_cursor.hpp"
+#include "reservation_table.hpp"
+#include "route_cache.hpp"
+#include "search_context.hpp"
+#include "search_stats.hpp"
+#include "sim_clock.hpp"
+#include "sipp.hpp"
+#include "stall_assignment.hpp"
+#include "stream_stats.hpp"
+#include "trace_log.hpp"
+#include "vehicle_table.hpp"
+#include "work_steal_pool.hpp"
 
 using namespace std;
 using namespace std::chrono;
 
 static mutex g_logMutex;
-static string g_runId;
 static ofstream g_assignmentFile;
-static int g_loggedCount = 0;
 
 enum CellType
 {
@@ -32,22 +54,6 @@ enum CellType
     VEHICLE
 };
 
-// --------------------------------------------------------------------
-// Cell：多了 occupiedBy 來避免多車同時改 waitTime
-// --------------------------------------------------------------------
-struct Cell
-{
-    int row, col;
-    CellType type;
-    int waitTime = 0;
-    char vehicleID;
-    bool isMoving = false;
-    char occupiedBy = '\0';
-
-    Cell(int r = 0, int c = 0, CellType t = AISLE)
-        : row(r), col(c), type(t), vehicleID(' ') {}
-};
-
 // --------------------------------------------------------------------
 // VehicleTime：紀錄「哪輛車(vehicleID)」「index 第幾台車」「time 統計值」
 // --------------------------------------------------------------------
@@ -66,51 +72,123 @@ private:
     static const int MAX_ROWS = 13;
     static const int MAX_COLS = 12;
 
-    vector<vector<Cell>> parkingLot;
+    // 地圖狀態：type / waitTime / 佔用 (VehicleId、occupiedBy) 各自一個平面，isMoving 與可通行為 bitboard
+    //   VehicleId = vehicleIndex + 1，字母 vehicleID 只用於顯示與 log
+    LotGrid parkingLot;
     mutable mutex mtx;
 
+    // 格子佔用 (owner = VehicleId)：前進一格以 CAS 佔下一格再釋放原格，不需要鎖
+    CellOccupancy occupancy;
+
+    // 可通行規則 (LotGrid pass class)，建構時依序定義
+    static constexpr int PASS_DRIVE = 0;  // isCellValid：通道，或正在移動的車輛
+    static constexpr int PASS_STATIC = 1; // ALT：牆與車位以外
+
+    // VehicleId -> 字母 vehicleID (顯示用)
+    vector<char> labels;
+
+    // 入口 (內建地圖為 (0,4))；載入的地圖可有多個入口，進場時選最近的一個
+    vector<pair<int, int>> entrances{{0, 4}};
+
     // 行駛時間 / 延遲時間
     vector<VehicleTime> vehicleTimes;
     vector<VehicleTime> delayTimes;
 
     bool useImprovedAStar = false;
+    SimClock *clock = nullptr;
+
+    // SIPP 模式：以每格的時間預約區間規劃，取代 waitTime 懲罰
+    bool useSipp = false;
+    ReservationTable reservations;
+
+    // 倒車 10 tick (countdown 9..0)，終點要預約到倒車結束
+    static const int PARK_HOLD_TICKS = 10;
+
+    // ALT 距離表 (--alt)：在 baseLot 上建一次，各實驗的複本共用 (唯讀)
+    shared_ptr<const LandmarkHeuristic> landmarks;
+
+    // --jps：A* 沿沒有岔路的直線通道一次跳到下一個決策點 (4 連通的 jump point search)
+    bool useJps = false;
 
-    struct Node
+    // --assign：每個 run 抽到的 20 個車位改以最小成本指派決定由第幾台車停 (取代抽到的順序)
+    bool useStallAssignment = false;
+
+    // --route-cache：相同查詢且讀過的區塊都沒變時沿用上次的路線 (baseLot 的各複本共用)
+    shared_ptr<RouteCache> routeCache;
+
+    // --render：地圖畫面 (單次執行才設定；批次模式沒有 renderer)
+    LotRenderer *renderer = nullptr;
+
+    // --trace：單次執行時每組實驗各寫一份軌跡 (tracePath 隨複本複製，writer 屬於一次實驗)
+    string tracePath;
+    TraceWriter *trace = nullptr;
+
+    // --------------------------------------------------------------------
+    // MoveState：一台車的行駛狀態，由 SimClock 事件逐 tick 推進
+    //   原本 while 迴圈 + sleep_for(1s) 的一圈 = advanceMove 一次 + 等 1 tick
+    // --------------------------------------------------------------------
+    enum MovePhase
     {
-        int row, col, g, h;
-        vector<pair<int, int>> path;
-        Node(int r, int c, int gVal, int hVal)
-            : row(r), col(c), g(gVal), h(hVal)
-        {
-            path.emplace_back(r, c);
-        }
-        int f() const { return g + h; }
-        bool operator>(const Node &other) const { return f() > other.f(); }
+        DRIVING,
+        PARKING,
+        FINISHED
+    };
+
+    struct MoveState
+    {
+        PathCursor path; // 前進只移動游標，不搬動剩餘路徑
+        char vehicleID;
+        int vehicleIndex;
+        VehicleId id;
+        int delay = 0;
+        MovePhase phase = DRIVING;
+        int parkCountdown = 9; // 倒車 9..0
+        long long startTick = 0;
     };
 
     // --------------------------------------------------------------------
     // moveVehicle：檢查 path 是否空，避免 segfault + occupant 機制 + 統計 delay
     // 加「vehicleIndex」參數，用於記錄到 vehicleTimes / delayTimes
     // --------------------------------------------------------------------
-    void moveVehicle(vector<pair<int, int>> &path, char vehicleID, int vehicleIndex)
+    void moveVehicle(vector<pair<int, int>> path, char vehicleID, int vehicleIndex)
+    {
+        auto st = make_shared<MoveState>();
+        st->path.reset(std::move(path));
+        st->vehicleID = vehicleID;
+        st->vehicleIndex = vehicleIndex;
+        st->id = idOf(vehicleIndex);
+
+        // 之後每個 tick 由 SimClock 的 agent 批次推進一步
+        if (beginMove(*st) && advanceMove(*st))
+            clock->addAgent([this, st]()
+                            { return advanceMove(*st); });
+    }
+
+    // 起點標記 + 終點 waitTime 合併 (occupant)
+    bool beginMove(MoveState &st)
     {
-        auto startTime = steady_clock::now();
+        PathCursor &path = st.path;
+        VehicleId id = st.id;
+        st.startTick = clock->now();
 
         if (path.empty())
         {
             cout << "[moveVehicle] path is empty => no move.\n";
-            return;
+            return false;
         }
         // 起點標記
-        parkingLot[path[0].first][path[0].second].type = VEHICLE;
-        parkingLot[path[0].first][path[0].second].vehicleID = vehicleID;
-        parkingLot[path[0].first][path[0].second].isMoving = true;
+        occupancy.place(parkingLot.index(path[0].first, path[0].second), id, CellOccupancy::DRIVING);
+        parkingLot.setType(path[0].first, path[0].second, VEHICLE);
+        parkingLot.setOccupant(path[0].first, path[0].second, id);
+        parkingLot.setMoving(path[0].first, path[0].second, true);
+        if (trace)
+            trace->vehicleAt(id, path[0].first, path[0].second);
 
         // 計算 wtSum
         int wtSum = 0;
         for (size_t i = 1; i + 1 < path.size(); i++)
         {
-            int cw = parkingLot[path[i].first][path[i].second].waitTime;
+            int cw = parkingLot.waitTime(path[i].first, path[i].second);
             if (cw > 0)
             {
                 int adj = cw - (int)i + 1;
@@ -122,11 +200,10 @@ private:
         int initialVal = (int)path.size() + 9 + wtSum;
 
         // 合併最後一格 occupant
-        if (!path.empty())
         {
             int rr = path.back().first;
             int cc = path.back().second;
-            int oldVal = parkingLot[rr][cc].waitTime;
+            int oldVal = parkingLot.waitTime(rr, cc);
 
             int distance = (int)path.size() - 1;
             if (distance < 0)
@@ -145,113 +222,116 @@ private:
 
             if (myVal > oldVal)
             {
-                parkingLot[rr][cc].occupiedBy = vehicleID;
-                parkingLot[rr][cc].waitTime = myVal;
+                parkingLot.setClaim(rr, cc, id);
+                parkingLot.setWaitTime(rr, cc, myVal);
             }
             else
             {
-                parkingLot[rr][cc].waitTime = oldVal;
+                parkingLot.setWaitTime(rr, cc, oldVal);
             }
         }
+        return true;
+    }
 
-        // 統計延遲
-        int delay = 0;
+    // --------------------------------------------------------------------
+    // advanceMove：推進一個 tick (原本 while 迴圈的一圈)
+    //   回傳 true => 需要再等 1 tick；false => 已結束並記錄統計
+    // --------------------------------------------------------------------
+    bool advanceMove(MoveState &st)
+    {
+        PathCursor &path = st.path;
+        VehicleId id = st.id;
 
-        // 移動
-        for (size_t i = 1; i < path.size();)
+        if (st.phase == DRIVING)
         {
-            if (path.size() <= 1)
-                break; // 只剩最後一格 => break
-
-            // 若下一格可進 => 移動
-            if (!parkingLot[path[i].first][path[i].second].isMoving)
+            if (path.size() > 1)
             {
-                pair<int, int> oldPos = path[0];
-                pair<int, int> newPos = path[i];
-
+                // SIPP 規劃的原地等待 (path 中重複同一格)
+                if (path[1] == path[0])
                 {
-                    lock_guard<mutex> lock(mtx);
-                    parkingLot[oldPos.first][oldPos.second].vehicleID = ' ';
-                    parkingLot[oldPos.first][oldPos.second].type = AISLE;
-                    parkingLot[oldPos.first][oldPos.second].isMoving = false;
-
-                    parkingLot[newPos.first][newPos.second].vehicleID = vehicleID;
-                    parkingLot[newPos.first][newPos.second].type = VEHICLE;
-                    parkingLot[newPos.first][newPos.second].isMoving = true;
+                    path.advance();
+                    st.delay++;
+                }
+                // 佔得到下一格 => 移動
+                else if (occupancy.tryMove(parkingLot.index(path[0].first, path[0].second),
+                                           parkingLot.index(path[1].first, path[1].second), id,
+                                           CellOccupancy::DRIVING))
+                {
+                    pair<int, int> oldPos = path[0];
+                    pair<int, int> newPos = path[1];
+
+                    // 顯示與可通行平面 (佔位已由 CAS 決定)
+                    parkingLot.setOccupant(oldPos.first, oldPos.second, NO_VEHICLE);
+                    parkingLot.setType(oldPos.first, oldPos.second, AISLE);
+                    parkingLot.setMoving(oldPos.first, oldPos.second, false);
+
+                    parkingLot.setOccupant(newPos.first, newPos.second, id);
+                    parkingLot.setType(newPos.first, newPos.second, VEHICLE);
+                    parkingLot.setMoving(newPos.first, newPos.second, true);
+                    // 游標前進一格
+                    path.advance();
+                    if (trace)
+                        trace->vehicleAt(id, newPos.first, newPos.second);
+                }
+                else
+                {
+                    // 無法前進 => delay++
+                    st.delay++;
                 }
-                // 移除 path.begin() => 前進
-                path.erase(path.begin());
-            }
-            else
-            {
-                // 無法前進 => delay++
-                delay++;
-            }
 
-            {
-                int r = path.back().first;
-                int c = path.back().second;
-                if (parkingLot[r][c].occupiedBy == vehicleID)
                 {
-                    int wtSum2 = 0;
-                    for (size_t k = 1; k < path.size() - 1; k++)
+                    int r = path.back().first;
+                    int c = path.back().second;
+                    // 認領者每 tick 把終點 waitTime 倒數 1 (O(1)，不再重掃剩餘路徑)
+                    if (parkingLot.claim(r, c) == id)
                     {
-                        int cellWait = parkingLot[path[k].first][path[k].second].waitTime;
-                        if (cellWait > 0)
+                        if (parkingLot.waitTime(r, c) > 0)
                         {
-                            int adj2 = cellWait - (int)k + 1;
-                            if (adj2 > 9)
-                                adj2 = 0;
-                            wtSum2 += std::max(adj2, 0);
+                            parkingLot.setWaitTime(r, c, parkingLot.waitTime(r, c) - 1);
                         }
                     }
-                    int baseVal2 = (int)path.size() + 9 + wtSum2;
-
-                    if (parkingLot[r][c].waitTime > 0)
-                    {
-                        parkingLot[r][c].waitTime--;
-                    }
                 }
+                // displayStatus(); // 大量測試時可註解
+                return true;
             }
-
-            this_thread::sleep_for(std::chrono::seconds(1));
-            // displayStatus(); // 大量測試時可註解
-
-            // 再檢查
-            if (path.size() <= 1)
-                break;
+            // 只剩最後一格 => 倒車
+            st.phase = PARKING;
+            occupancy.setState(parkingLot.index(path.back().first, path.back().second), id, CellOccupancy::PARKING);
         }
 
         // 倒車9秒
-        if (!path.empty() && path.size() == 1)
+        if (st.phase == PARKING && st.parkCountdown >= 0)
         {
             int rr = path.back().first;
             int cc = path.back().second;
-            for (int j = 9; j >= 0; j--)
+            int j = st.parkCountdown--;
+            parkingLot.setWaitTime(rr, cc, j);
+            if (j == 0)
             {
-                parkingLot[rr][cc].waitTime = j;
-                if (j == 0)
-                {
-                    parkingLot[rr][cc].type = AISLE;
-                    parkingLot[rr][cc].waitTime = 0;
-                    parkingLot[rr][cc].vehicleID = ' ';
-                    parkingLot[rr][cc].isMoving = false;
-                    parkingLot[rr][cc].occupiedBy = '\0';
-                }
-                this_thread::sleep_for(std::chrono::seconds(1));
-                // displayStatus();
+                occupancy.release(parkingLot.index(rr, cc), id);
+                parkingLot.setType(rr, cc, AISLE);
+                parkingLot.setWaitTime(rr, cc, 0);
+                parkingLot.setOccupant(rr, cc, NO_VEHICLE);
+                parkingLot.setMoving(rr, cc, false);
+                parkingLot.setClaim(rr, cc, NO_VEHICLE);
+                if (trace)
+                    trace->vehicleGone(id);
             }
+            // displayStatus();
+            return true;
         }
 
-        auto endTime = steady_clock::now();
-        auto duration = duration_cast<seconds>(endTime - startTime).count();
-
+        st.phase = FINISHED;
+        long long duration = clock->now() - st.startTick;
         {
             lock_guard<mutex> lock(mtx);
             // 在這裡把 vehicleIndex 也記進去
-            vehicleTimes.emplace_back(vehicleID, vehicleIndex, (long long)duration);
-            delayTimes.emplace_back(vehicleID, vehicleIndex, (long long)delay);
+            vehicleTimes.emplace_back(st.vehicleID, st.vehicleIndex, duration);
+            delayTimes.emplace_back(st.vehicleID, st.vehicleIndex, (long long)st.delay);
         }
+        if (trace)
+            trace->event(TraceEvent::Arrive, id, (uint32_t)duration);
+        return false;
     }
 
     //--------------------------------------------------------------------------------
@@ -260,10 +340,7 @@ private:
     //--------------------------------------------------------------------------------
     bool isCellValid(int row, int col) const
     {
-        return (row >= 0 && row < (int)parkingLot.size() &&
-                col >= 0 && col < (int)parkingLot[0].size() &&
-                (parkingLot[row][col].type == AISLE ||
-                 (parkingLot[row][col].type == VEHICLE && parkingLot[row][col].isMoving)));
+        return parkingLot.passable(PASS_DRIVE, row, col);
     }
 
     void aStar(int sr, int sc, int er, int ec, char vehicleID, int vehicleIndex)
@@ -273,79 +350,170 @@ private:
             cout << "Invalid start or end pos.\n";
             return;
         }
-        priority_queue<Node, vector<Node>, greater<Node>> pq;
-        vector<vector<int>> cost(parkingLot.size(), vector<int>(parkingLot[0].size(), INT_MAX));
-
-        cost[sr][sc] = 0;
-        pq.emplace(sr, sc, 0, calcHeuristic(sr, sc, er, ec));
+        if (useSipp && sippRoute(sr, sc, er, ec, vehicleID, vehicleIndex))
+            return;
 
-        while (!pq.empty())
+        // 路線快取：讀過的區塊都沒變 => 搜尋結果相同，直接沿用
+        // 每次搜尋的計數 (-DSEARCH_STATS=ON 時才編進來)
+        SEARCH_STAT(SearchProbe probe(useImprovedAStar ? "improved" : "traditional", idOf(vehicleIndex), sr, sc, er, ec));
+        auto t0 = steady_clock::now();
+        RouteCache::Key key{sr, sc, er, ec, plannerMode()};
+        RouteDeps *deps = nullptr;
+        if (routeCache)
         {
-            Node cur = pq.top();
-            pq.pop();
-
-            if (cur.row == er && cur.col == ec)
+            vector<pair<int, int>> cached;
+            if (routeCache->lookup(key, parkingLot, cached))
             {
-                moveVehicle(cur.path, vehicleID, vehicleIndex);
+                routeCache->addHitTime(elapsedNanos(t0));
+                SEARCH_STAT(probe.cached(cached.size()));
+                moveVehicle(std::move(cached), vehicleID, vehicleIndex);
                 return;
             }
-            static const int DR[4] = {-1, 1, 0, 0};
-            static const int DC[4] = {0, 0, -1, 1};
+            deps = &RouteDeps::local();
+            deps->begin(parkingLot);
+        }
 
-            for (int i = 0; i < 4; i++)
+        // 節點放在 pool 裡，只記 parent 索引；cost / closed / open list 用執行緒自己的工作區
+        //   搜尋本身是 grid_astar.hpp 的共用核心 (astar_bench 量測的也是它)
+        AStarHooks hooks;
+        hooks.deps = deps;
+        SEARCH_STAT(hooks.probe = &probe);
+        GridAStarConfig cfg;
+        cfg.passClass = PASS_DRIVE;
+        cfg.improved = useImprovedAStar;
+        cfg.jps = useJps;
+        auto heuristic = [this](int r, int c, int gr, int gc)
+        { return calcHeuristic(r, c, gr, gc); };
+        auto plainCell = [this](int r, int c)
+        { return parkingLot.type(r, c) == VEHICLE; };
+        vector<pair<int, int>> path;
+        int goalG = 0;
+        if (gridAStar(parkingLot, cfg, sr, sc, er, ec, heuristic, plainCell, hooks, path, &goalG))
+        {
+            if (deps)
             {
-                int nr = cur.row + DR[i];
-                int nc = cur.col + DC[i];
-                if (isCellValid(nr, nc))
-                {
-                    int baseG = cur.g + 1;
-                    int extra = 0;
-                    if (useImprovedAStar)
-                    {
-                        int w = parkingLot[nr][nc].waitTime;
-                        int remain = w - baseG;
-                        if (remain > 0)
-                            extra = remain;
-                    }
-                    int newG = baseG + extra;
-
-                    if (newG < cost[nr][nc])
-                    {
-                        cost[nr][nc] = newG;
-                        Node nxt(nr, nc, newG, calcHeuristic(nr, nc, er, ec));
-                        nxt.path = cur.path;
-                        nxt.path.emplace_back(nr, nc);
-                        pq.push(nxt);
-                    }
-                }
+                routeCache->store(key, path, *deps);
+                routeCache->addMissTime(elapsedNanos(t0));
             }
+            SEARCH_STAT(probe.finish(true, path.size(), goalG));
+            moveVehicle(std::move(path), vehicleID, vehicleIndex);
+            return;
         }
+        if (deps)
+            routeCache->addMissTime(elapsedNanos(t0));
         cout << "No valid path found.\n";
     }
 
+    // gridAStar 的 hooks：路線快取讀過的格子 + 每次搜尋的計數
+    struct AStarHooks : SearchHooks
+    {
+        RouteDeps *deps = nullptr;
+        void visit(int r, int c)
+        {
+            if (deps)
+                deps->addCell(r, c);
+        }
+#ifdef SEARCH_STATS
+        SearchProbe *probe = nullptr;
+        void push() { probe->push(); }
+        void stalePop() { probe->stalePop(); }
+        void penalty(int extra) { probe->penalty(extra); }
+        void searched(const SearchContext &ctx) { probe->searched(ctx); }
+#endif
+    };
+
+    // 快取 key 的規劃模式：會影響搜尋結果的設定
+    uint32_t plannerMode() const
+    {
+        return (useImprovedAStar ? 1u : 0u) | (useJps ? 2u : 0u) | (landmarks ? 4u : 0u);
+    }
+
+    static uint64_t elapsedNanos(steady_clock::time_point t0)
+    {
+        return (uint64_t)duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+    }
+
     int calcHeuristic(int r1, int c1, int r2, int c2)
     {
+        if (landmarks)
+            return landmarks->estimate(r1, c1, r2, c2);
         return abs(r2 - r1) + abs(c2 - c1);
     }
 
+    // 靜態可通行：牆與車位以外 (車輛只會出現在通道上)
+    bool isStaticPassable(int r, int c) const
+    {
+        return parkingLot.passable(PASS_STATIC, r, c);
+    }
+
+    //--------------------------------------------------------------------------------
+    // sippRoute：在 ReservationTable 上做 SIPP，得到無衝突、時間最短的路線
+    //   時間軸：path[0] 於 now-1 進入 (第一次 advanceMove 在 now 就走到 path[1])
+    //   path[k] 於 now-1+k 進入，佔用 [進入, 離開]；終點再多佔倒車的 10 tick
+    //   找不到 (或超過展開上限) 回傳 false，由呼叫端退回一般 A*
+    //   可通行與 A* 相同 (PASS_DRIVE)：車位上的 VEHICLE (已停好或已指派的車) 不會移動，永遠不可通行；
+    //   行駛中的車輛可通行，與它們的衝突交給 reservation table
+    //--------------------------------------------------------------------------------
+    bool sippRoute(int sr, int sc, int er, int ec, char vehicleID, int vehicleIndex)
+    {
+        int t0 = (int)clock->now() - 1;
+        auto passable = [this](int r, int c)
+        {
+            return parkingLot.passable(PASS_DRIVE, r, c);
+        };
+        vector<pair<int, int>> path;
+        if (!sippPlan(reservations, parkingLot.rows(), parkingLot.cols(), sr, sc, t0,
+                      er, ec, PARK_HOLD_TICKS, passable, path))
+        {
+            return false;
+        }
+
+        // 同一格連續出現 (等待) 合併成一筆預約
+        size_t k = 0;
+        while (k < path.size())
+        {
+            size_t j = k;
+            while (j + 1 < path.size() && path[j + 1] == path[k])
+                j++;
+            int arrive = t0 + (int)k;
+            int leave = (j + 1 < path.size()) ? t0 + (int)j + 1 : t0 + (int)j + PARK_HOLD_TICKS;
+            reservations.reserve(path[k].first, path[k].second, arrive, leave, vehicleIndex, t0);
+            k = j + 1;
+        }
+        moveVehicle(std::move(path), vehicleID, vehicleIndex);
+        return true;
+    }
+
 public:
     // 小地圖 13×12
     ParkingLot()
     {
-        parkingLot.resize(MAX_ROWS, vector<Cell>(MAX_COLS));
-        for (int i = 0; i < MAX_ROWS; i++)
-        {
-            for (int j = 0; j < MAX_COLS; j++)
-            {
-                parkingLot[i][j] = Cell(i, j, AISLE);
-            }
-        }
+        parkingLot.reset(MAX_ROWS, MAX_COLS, AISLE);
+        //                               ENTRANCE, AISLE, WALL, PARKING_SPACE, VEHICLE
+        parkingLot.definePassClass({LotGrid::PASS_NEVER, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER,
+                                    LotGrid::PASS_NEVER, LotGrid::PASS_IF_MOVING});
+        parkingLot.definePassClass({LotGrid::PASS_ALWAYS, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER,
+                                    LotGrid::PASS_NEVER, LotGrid::PASS_ALWAYS});
+        parkingLot.setStampClasses(1u << PASS_DRIVE); // A* 只讀 PASS_DRIVE (SIPP 不經過路線快取)
+        reservations.reset(MAX_ROWS, MAX_COLS);
+        occupancy.reset((size_t)MAX_ROWS * MAX_COLS);
     }
 
     ParkingLot(const ParkingLot &other)
     {
         this->parkingLot = other.parkingLot;
         this->useImprovedAStar = other.useImprovedAStar;
+        this->useSipp = other.useSipp;
+        this->landmarks = other.landmarks;
+        this->useJps = other.useJps;
+        this->useStallAssignment = other.useStallAssignment;
+        this->renderer = other.renderer;
+        this->tracePath = other.tracePath;
+        this->routeCache = other.routeCache;
+        this->entrances = other.entrances;
+        // 預約與佔用屬於一次實驗，複本從空表開始
+        this->reservations.reset(parkingLot.rows(), parkingLot.cols());
+        this->occupancy.reset((size_t)parkingLot.rows() * parkingLot.cols());
     }
 
     void setUseImprovedAStar(bool improved)
@@ -353,32 +521,206 @@ public:
         useImprovedAStar = improved;
     }
 
-    const vector<vector<Cell>> &getParkingLot() const
+    void setUseSipp(bool sipp)
+    {
+        useSipp = sipp;
+    }
+
+    bool isUsingSipp() const
+    {
+        return useSipp;
+    }
+
+    void setUseJps(bool jps)
+    {
+        useJps = jps;
+    }
+
+    void setUseStallAssignment(bool assign)
+    {
+        useStallAssignment = assign;
+    }
+
+    bool isUsingStallAssignment() const
+    {
+        return useStallAssignment;
+    }
+
+    // 20 台車視為一波：從每個入口做一次 Dijkstra 得到到各車位的成本，再以最小成本指派重排 spaces
+    //   (spaces[i] = 第 i 台進場車的車位)；車位旁的通道格、入口的選法與 addVehicle 相同
+    //   在 baseLot (尚未放車) 上計算，傳統 / 改良兩組使用同一個順序
+    void orderByAssignment(vector<pair<int, int>> &spaces) const
+    {
+        vector<DistanceField> fields(entrances.size());
+        for (size_t e = 0; e < entrances.size(); e++)
+            fields[e].build(parkingLot, PASS_DRIVE, entrances[e].first, entrances[e].second, true);
+
+        // 沒有相鄰通道的車位以 (車位本身) 當終點 => 不可到達，留給最後沒配到的車
+        vector<StallCandidate> cands;
+        int dirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        for (auto &s : spaces)
+        {
+            StallCandidate cand{s.first, s.second, s.first, s.second, 0};
+            for (auto &dir : dirs)
+            {
+                int nr = s.first + dir[0];
+                int nc = s.second + dir[1];
+                if (isCellValid(nr, nc))
+                {
+                    pair<int, int> in = nearestEntrance(nr, nc);
+                    cand = StallCandidate{s.first, s.second, nr, nc,
+                                          (int)(find(entrances.begin(), entrances.end(), in) - entrances.begin())};
+                    break;
+                }
+            }
+            cands.push_back(cand);
+        }
+
+        // 車位已經抽好，只決定順序：不做間隔篩選、候選就是這 20 個
+        WaveOptions opt;
+        opt.parkTicks = PARK_HOLD_TICKS;
+        opt.spacing = 0;
+        opt.poolFactor = 1;
+        vector<int> pick = assignWave(cands, fields, (int)spaces.size(), {}, opt);
+        vector<bool> taken(spaces.size(), false);
+        for (int k : pick)
+        {
+            if (k >= 0)
+                taken[k] = true;
+        }
+        vector<pair<int, int>> ordered(spaces.size());
+        size_t rest = 0;
+        for (size_t i = 0; i < spaces.size(); i++)
+        {
+            int k = pick[i];
+            if (k < 0)
+            {
+                while (taken[rest])
+                    rest++;
+                taken[rest] = true;
+                k = (int)rest;
+            }
+            ordered[i] = spaces[k];
+        }
+        spaces = std::move(ordered);
+    }
+
+    // 依目前 (尚未放車的) 地圖建立 ALT 距離表：入口 + 四個角落
+    size_t enableLandmarks()
+    {
+        auto passable = [this](int r, int c)
+        { return isStaticPassable(r, c); };
+        int rows = parkingLot.rows(), cols = parkingLot.cols();
+        auto table = make_shared<LandmarkHeuristic>();
+        table->build(rows, cols, LandmarkHeuristic::pickLandmarks(rows, cols, passable, entrances), passable);
+        landmarks = table;
+        return table->landmarkCount();
+    }
+
+    void enableRouteCache()
+    {
+        routeCache = make_shared<RouteCache>();
+    }
+
+    const RouteCache *getRouteCache() const
+    {
+        return routeCache.get();
+    }
+
+    // 每次實驗使用自己的 SimClock (virtual 或 realtime)
+    void setClock(SimClock *c)
+    {
+        clock = c;
+    }
+
+    const LotGrid &getParkingLot() const
     {
         return parkingLot;
     }
 
+    // 以執行期載入的地圖取代內建地圖 (尺寸、入口、車位都來自 layout)
+    void loadLayout(const LotLayout &layout)
+    {
+        parkingLot.reset(layout.rows, layout.cols, AISLE);
+        for (int r = 0; r < layout.rows; r++)
+        {
+            for (int c = 0; c < layout.cols; c++)
+            {
+                CellType t = AISLE;
+                switch (layout.at(r, c))
+                {
+                case LayoutCell::Wall:
+                    t = WALL;
+                    break;
+                case LayoutCell::Stall:
+                    t = PARKING_SPACE;
+                    break;
+                default: // 通道、入口、出口
+                    break;
+                }
+                parkingLot.setType(r, c, t);
+            }
+        }
+        entrances = layout.entrances;
+        reservations.reset(layout.rows, layout.cols);
+        occupancy.reset((size_t)layout.rows * layout.cols);
+    }
+
+    // 目前地圖轉成 LotLayout (--save-layout)
+    LotLayout toLayout() const
+    {
+        LotLayout layout;
+        layout.reset(parkingLot.rows(), parkingLot.cols());
+        for (int r = 0; r < layout.rows; r++)
+        {
+            for (int c = 0; c < layout.cols; c++)
+            {
+                uint8_t t = parkingLot.type(r, c);
+                layout.set(r, c, t == WALL ? LayoutCell::Wall : t == PARKING_SPACE ? LayoutCell::Stall : LayoutCell::Aisle);
+            }
+        }
+        for (auto &e : entrances)
+            layout.set(e.first, e.second, LayoutCell::Entrance);
+        layout.collectPortals();
+        return layout;
+    }
+
+    pair<int, int> nearestEntrance(int r, int c) const
+    {
+        pair<int, int> best = entrances[0];
+        for (auto &e : entrances)
+        {
+            if (abs(e.first - r) + abs(e.second - c) < abs(best.first - r) + abs(best.second - c))
+                best = e;
+        }
+        return best;
+    }
+
     void addCell(int r, int c, CellType t)
     {
-        if (r >= 0 && r < (int)parkingLot.size() && c >= 0 && c < (int)parkingLot[0].size())
+        if (r >= 0 && r < parkingLot.rows() && c >= 0 && c < parkingLot.cols())
         {
-            parkingLot[r][c].type = t;
+            parkingLot.setType(r, c, t);
         }
     }
 
-    // 將「車輛」放在 (row,col) => 跑 aStar(0,4 => row+dir, col+dir)
+    // 將「車輛」放在 (row,col) => 跑 aStar(入口 => row+dir, col+dir)
     // 加了 vehicleIndex 參數
     bool addVehicle(int row, int col, char vehicleID, int vehicleIndex)
     {
-        if (row < 0 || row >= (int)parkingLot.size() || col < 0 || col >= (int)parkingLot[0].size())
+        if (row < 0 || row >= parkingLot.rows() || col < 0 || col >= parkingLot.cols())
         {
             cout << "(addVehicle) invalid pos.\n";
             return false;
         }
-        if (parkingLot[row][col].type == PARKING_SPACE)
+        if (parkingLot.type(row, col) == PARKING_SPACE)
         {
-            parkingLot[row][col].type = VEHICLE;
-            parkingLot[row][col].vehicleID = vehicleID;
+            VehicleId id = idOf(vehicleIndex);
+            if (labels.size() < id)
+                labels.resize(id, '\0');
+            labels[id - 1] = vehicleID;
+            parkingLot.setType(row, col, VEHICLE);
+            parkingLot.setOccupant(row, col, id);
 
             // 找相鄰 aisles
             int dirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
@@ -388,7 +730,8 @@ public:
                 int nc = col + dir[1];
                 if (isCellValid(nr, nc))
                 {
-                    aStar(0, 4, nr, nc, vehicleID, vehicleIndex);
+                    pair<int, int> entrance = nearestEntrance(nr, nc);
+                    aStar(entrance.first, entrance.second, nr, nc, vehicleID, vehicleIndex);
                     return true;
                 }
             }
@@ -402,6 +745,21 @@ public:
         }
     }
 
+    static VehicleId idOf(int vehicleIndex)
+    {
+        return (VehicleId)vehicleIndex + 1;
+    }
+
+    // 顯示用字元：沿用字母 vehicleID，沒有登記時依 ID 循環使用 A~Z
+    char glyphOf(VehicleId id) const
+    {
+        if (id == NO_VEHICLE)
+            return ' ';
+        if (id <= labels.size() && labels[id - 1] != '\0')
+            return labels[id - 1];
+        return vehicleGlyph(id, VehicleRole::Arriving);
+    }
+
     // 取得行駛時間
     vector<VehicleTime> getVehicleTimes() const
     {
@@ -413,162 +771,704 @@ public:
         return delayTimes;
     }
 
-    // 顯示地圖(可註解掉)
+    void setRenderer(LotRenderer *r)
+    {
+        renderer = r;
+    }
+
+    bool hasActiveRenderer() const
+    {
+        return renderer && renderer->active();
+    }
+
+    void setTracePath(const string &path)
+    {
+        tracePath = path;
+    }
+
+    // 這一組實驗的軌跡檔：FILE 的副檔名前加上 .traditional / .improved
+    string traceFileName() const
+    {
+        string group = useImprovedAStar ? ".improved" : ".traditional";
+        size_t dot = tracePath.find_last_of('.');
+        size_t slash = tracePath.find_last_of("/\\");
+        if (dot == string::npos || (slash != string::npos && dot < slash))
+            return tracePath + group;
+        return tracePath.substr(0, dot) + group + tracePath.substr(dot);
+    }
+
+    // 從目前的地圖 (放車前) 開始記錄；type 的顯示字元依 CellType 順序
+    bool startTrace(TraceWriter &w)
+    {
+        if (tracePath.empty() || !w.open(traceFileName(), parkingLot, "  +-*"))
+            return false;
+        trace = &w;
+        return true;
+    }
+
+    void stopTrace()
+    {
+        trace = nullptr;
+    }
+
+    bool wantsTrace() const
+    {
+        return !tracePath.empty();
+    }
+
+    // 每個 tick 結束時呼叫 (SimClock 的 tick observer)
+    void endTick(SimClock::Tick tick)
+    {
+        if (trace)
+            trace->endTick(tick);
+        displayStatus();
+    }
+
+    // 顯示地圖：把目前地圖的字元快照交給 renderer (由 SimClock 在每個 tick 結束時呼叫)
+    //   輸出在 renderer 自己的執行緒上；沒有 renderer 或 headless 時直接返回
     void displayStatus()
     {
-        static std::atomic_flag isDisp = ATOMIC_FLAG_INIT;
-        if (isDisp.test_and_set())
+        if (!hasActiveRenderer())
             return;
-        try
-        {
-            static std::atomic<long long> lastD(0);
-            auto now = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
-            if (now - lastD >= 1000)
-            {
-                lastD = now;
-                system("cls");
-                cout << "   ";
-                for (int c = 0; c < MAX_COLS; c++)
-                {
-                    cout << (c % 10) << " ";
-                }
-                cout << "\n";
-                for (int r = 0; r < MAX_ROWS; r++)
-                {
-                    cout << (r % 10) << " ";
-                    for (int c = 0; c < MAX_COLS; c++)
-                    {
-                        char ch = ' ';
-                        if (parkingLot[r][c].waitTime > 0)
-                        {
-                            ch = '0' + (parkingLot[r][c].waitTime % 10);
-                        }
-                        else
-                        {
-                            switch (parkingLot[r][c].type)
-                            {
-                            case ENTRANCE:
-                            case AISLE:
-                                ch = ' ';
-                                break;
-                            case WALL:
-                                ch = '+';
-                                break;
-                            case PARKING_SPACE:
-                                ch = '-';
-                                break;
-                            case VEHICLE:
-                                ch = parkingLot[r][c].vehicleID;
-                                break;
-                            }
-                        }
-                        cout << ch << " ";
-                    }
-                    cout << "\n";
-                }
-                cout << "\n";
-            }
-        }
-        catch (...)
-        {
-            isDisp.clear();
-            throw;
-        }
-        isDisp.clear();
+        string caption = string(useImprovedAStar ? "Improved A*" : "Traditional A*") + "  t=" +
+                         to_string(clock ? clock->now() : 0);
+        renderer->publish(parkingLot.rows(), parkingLot.cols(), caption, [this](int r, int c)
+                          {
+                              if (parkingLot.waitTime(r, c) > 0)
+                                  return (char)('0' + (parkingLot.waitTime(r, c) % 10));
+                              switch (parkingLot.type(r, c))
+                              {
+                              case WALL:
+                                  return '+';
+                              case PARKING_SPACE:
+                                  return '-';
+                              case VEHICLE:
+                                  return glyphOf(parkingLot.occupant(r, c));
+                              default: // ENTRANCE、AISLE
+                                  return ' ';
+                              } });
     }
 };
 
-void addVehicleLogged(ParkingLot &lot, char vehicleID, int row, int col, int index)
+// 每個 run 的 assignment 記錄：vehicle_assignments.csv 只記該 run 的前 20 筆
+struct RunLog
 {
-    if (g_loggedCount < 20)
+    string runId;
+    int loggedCount = 0;
+};
+
+void addVehicleLogged(ParkingLot &lot, RunLog &log, char vehicleID, int row, int col, int index)
+{
+    if (log.loggedCount < 20)
     {
         auto now = system_clock::now();
         std::time_t tt = system_clock::to_time_t(now);
         char buf[20];
-        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&tt));
         {
-            lock_guard<mutex> lock(g_logMutex);
-            g_assignmentFile << g_runId << ',' << vehicleID << ',' << row << ',' << col << ',' << buf << '\n';
+            lock_guard<mutex> lock(g_logMutex); // localtime 非 thread-safe，一起放在鎖內
+            std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&tt));
+            g_assignmentFile << log.runId << ',' << vehicleID << ',' << row << ',' << col << ',' << buf << '\n';
         }
-        ++g_loggedCount;
+        ++log.loggedCount;
     }
     lot.addVehicle(row, col, vehicleID, index);
 }
 
 // ----------------------------------------------------------------------
 // For Average
+//   「前10輛」 => vehicleIndex < frontCount；「後10輛」 => 其餘
+//   兩段各一份 RunningStats，mean 與原本的「加總 / 台數」相同 (沒有車時為 0)
 // ----------------------------------------------------------------------
-double calcAverageOfFirstN(const vector<VehicleTime> &arr, int N)
+struct FrontBackStats
 {
-    if (arr.empty())
-        return 0.0;
-    int limit = min((int)arr.size(), N);
-    long long sum = 0;
-    for (int i = 0; i < limit; i++)
+    RunningStats front, back;
+    double frontMean() const { return front.count() ? front.mean() : 0.0; }
+    double backMean() const { return back.count() ? back.mean() : 0.0; }
+};
+
+FrontBackStats splitFrontBack(const vector<VehicleTime> &arr, int frontCount)
+{
+    FrontBackStats s;
+    for (auto &vt : arr)
     {
-        sum += arr[i].time;
+        if (vt.vehicleIndex < frontCount)
+            s.front.add((double)vt.time);
+        else
+            s.back.add((double)vt.time);
     }
-    return (limit > 0) ? (double)sum / limit : 0.0;
+    return s;
 }
-double calcAverageOfLastN(const vector<VehicleTime> &arr, int N)
+
+// 車輛互卡時不會自然結束，一次實驗最多跑這麼多 tick
+static const long long MAX_SIM_TICKS = 3600;
+
+// ----------------------------------------------------------------------
+// runExperiment：在一份 ParkingLot 上依序放入所有車輛 (每 2 秒一台)
+//   arrival 與每台車的移動都是 SimClock 事件；virtual 模式毫秒內跑完，
+//   realtime 模式照牆上時間逐秒執行，兩者結果相同
+// ----------------------------------------------------------------------
+void runExperiment(ParkingLot &lot, RunLog &log, bool realtime, const vector<char> &vehicleIDs,
+                   const vector<pair<int, int>> &parkingSpaces)
 {
-    if (arr.empty())
-        return 0.0;
-    int sz = (int)arr.size();
-    int start = max(sz - N, 0);
-    long long sum = 0;
-    for (int i = start; i < sz; i++)
+    SimClock clock(realtime);
+    lot.setClock(&clock);
+    TraceWriter trace;
+    if (lot.wantsTrace() && !lot.startTrace(trace))
+        cout << "Cannot write " << lot.traceFileName() << "\n";
+    if (lot.hasActiveRenderer() || trace.isOpen())
+        clock.setTickObserver([&lot](SimClock::Tick t)
+                              { lot.endTick(t); });
+    for (int i = 0; i < (int)vehicleIDs.size(); i++)
+    {
+        char vID = vehicleIDs[i];
+        auto ps = parkingSpaces[i];
+        clock.schedule(2LL * i, [&lot, &log, vID, ps, i]()
+                       { addVehicleLogged(lot, log, vID, ps.first, ps.second, i); });
+    }
+    auto simStart = steady_clock::now();
+    clock.run(MAX_SIM_TICKS);
+    double simMs = duration<double, milli>(steady_clock::now() - simStart).count();
+    if (!clock.idle())
     {
-        sum += arr[i].time;
+        cout << "Simulation stopped at tick " << clock.now() << " (vehicles still blocked).\n";
     }
-    int count = sz - start;
-    return (count > 0) ? (double)sum / count : 0.0;
+    if (trace.isOpen())
+    {
+        lot.stopTrace();
+        uint64_t ticks = trace.ticksRecorded();
+        double recordMs = trace.recordMillis();
+        if (!trace.close())
+            cout << "Cannot write " << lot.traceFileName() << "\n";
+        else
+            cout << "[trace] " << lot.traceFileName() << ": " << ticks << " ticks, " << trace.bytesWritten()
+                 << " bytes, recording " << recordMs << " ms of " << simMs << " ms simulation\n";
+    }
+    lot.setClock(nullptr);
 }
 
-// 取「前10輛」 => vehicleIndex < 10
-// 取「後10輛」 => vehicleIndex >= 10
-// ex: "frontAvg( times, 0,10 )"
-double calcAverageByIndexRange(const vector<VehicleTime> &arr, int beginIdx, int endIdx)
+// ----------------------------------------------------------------------
+// RunResult：一次 Traditional vs Improved 比較 (= results CSV 的一列)
+// ----------------------------------------------------------------------
+struct RunResult
 {
-    // 針對 arr 裡 vehicleIndex 在 [beginIdx, endIdx) 區間的做平均
-    if (arr.empty())
-        return 0.0;
-    long long sum = 0;
-    int count = 0;
-    for (auto &vt : arr)
+    double tfrontTime, tbackTime, tfrontDelay, tbackDelay;
+    double ifrontTime, ibackTime, ifrontDelay, ibackDelay;
+};
+
+static const int VEHICLE_COUNT = 20;
+
+// 每個 run 自己的 seed (splitmix64)，與執行緒數、完成順序無關
+unsigned deriveRunSeed(unsigned long long baseSeed, long long runId)
+{
+    unsigned long long z = baseSeed + 0x9E3779B97F4A7C15ULL * (unsigned long long)(runId + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (unsigned)(z ^ (z >> 31));
+}
+
+// ----------------------------------------------------------------------
+// BatchSummary：批次執行時即時累計的統計，不必事後再讀一遍 CSV
+//   每個 run：results CSV 的 12 個欄位，以及同一個 run 兩組的配對差 (trad - impr)
+//   每台車：兩組各自的 time / delay，以及同一台車 (同 vehicleIndex) 兩組的配對差
+//   每欄都有平均、標準差、平均的 95% 信賴區間與百分位數；每個 worker 一份，批次結束後 merge
+// ----------------------------------------------------------------------
+struct BatchSummary
+{
+    enum Column
+    {
+        T_FRONT_TIME, T_BACK_TIME, T_FRONT_DELAY, T_BACK_DELAY,
+        I_FRONT_TIME, I_BACK_TIME, I_FRONT_DELAY, I_BACK_DELAY,
+        FRONT_TIME_PCT, BACK_TIME_PCT, FRONT_DELAY_PCT, BACK_DELAY_PCT,
+        FRONT_TIME_DIFF, BACK_TIME_DIFF, FRONT_DELAY_DIFF, BACK_DELAY_DIFF,
+        VEHICLE_TTIME, VEHICLE_ITIME, VEHICLE_TIME_DIFF,
+        VEHICLE_TDELAY, VEHICLE_IDELAY, VEHICLE_DELAY_DIFF,
+        COLUMN_COUNT
+    };
+    static const char *name(int col)
+    {
+        static const char *const NAMES[COLUMN_COUNT] = {
+            "tfront_time", "tback_time", "tfront_delay", "tback_delay",
+            "ifront_time", "iback_time", "ifront_delay", "iback_delay",
+            "front_time_pct", "back_time_pct", "front_delay_pct", "back_delay_pct",
+            "front_time_diff", "back_time_diff", "front_delay_diff", "back_delay_diff",
+            "vehicle_ttime", "vehicle_itime", "vehicle_time_diff",
+            "vehicle_tdelay", "vehicle_idelay", "vehicle_delay_diff"};
+        return NAMES[col];
+    }
+
+    StreamSummary columns[COLUMN_COUNT];
+
+    void addRun(const RunResult &r)
+    {
+        const double trad[4] = {r.tfrontTime, r.tbackTime, r.tfrontDelay, r.tbackDelay};
+        const double impr[4] = {r.ifrontTime, r.ibackTime, r.ifrontDelay, r.ibackDelay};
+        for (int k = 0; k < 4; k++)
+        {
+            columns[T_FRONT_TIME + k].add(trad[k]);
+            columns[I_FRONT_TIME + k].add(impr[k]);
+            columns[FRONT_TIME_DIFF + k].add(trad[k] - impr[k]);
+            // 與 CSV 相同：trad 為 0 時 pct 留空 (不計入)
+            if (trad[k] != 0.0)
+                columns[FRONT_TIME_PCT + k].add((trad[k] - impr[k]) / trad[k] * 100.0);
+        }
+    }
+
+    // col = VEHICLE_TTIME 或 VEHICLE_TDELAY；之後兩欄依序為改良組與配對差
+    void addVehicles(const vector<VehicleTime> &trad, const vector<VehicleTime> &impr, int col)
+    {
+        long long tradTime[VEHICLE_COUNT];
+        bool done[VEHICLE_COUNT] = {};
+        for (auto &vt : trad)
+        {
+            columns[col].add((double)vt.time);
+            if (vt.vehicleIndex >= 0 && vt.vehicleIndex < VEHICLE_COUNT)
+            {
+                tradTime[vt.vehicleIndex] = vt.time;
+                done[vt.vehicleIndex] = true;
+            }
+        }
+        for (auto &vt : impr)
+        {
+            columns[col + 1].add((double)vt.time);
+            if (vt.vehicleIndex >= 0 && vt.vehicleIndex < VEHICLE_COUNT && done[vt.vehicleIndex])
+                columns[col + 2].add((double)(tradTime[vt.vehicleIndex] - vt.time));
+        }
+    }
+
+    void merge(const BatchSummary &o)
+    {
+        for (int c = 0; c < COLUMN_COUNT; c++)
+            columns[c].merge(o.columns[c]);
+    }
+};
+
+// ----------------------------------------------------------------------
+// runComparison：
+//   1) 用 seed 打亂車位 + 產生 20 個不重複 vehicleID
+//   2) parkingLotOriginal、parkingLotImproved (皆為 baseLot 的複本)
+//   3) Each => addVehicle(..., index)
+//   4) 回傳 front10 / back10 平均；summary 不為 nullptr 時順便累計每台車與這個 run 的統計
+// 所有亂數都來自這個 run 自己的 engine，可在多執行緒下同時跑
+// ----------------------------------------------------------------------
+RunResult runComparison(const ParkingLot &baseLot, vector<pair<int, int>> allSpaces, unsigned seed,
+                        RunLog &log, bool realtime, bool verbose, BatchSummary *summary = nullptr)
+{
+    // 打亂 => 取得前 20 個
+    std::mt19937 eng(seed);
+    std::shuffle(allSpaces.begin(), allSpaces.end(), eng);
+
+    vector<char> vehicleIDs(VEHICLE_COUNT);
+    vector<pair<int, int>> parkingSpaces(VEHICLE_COUNT);
+
+    // 產生 20 個不重複車位
+    // 也產生 20 個不重複的 vehicleID
+    unordered_set<char> usedIDs;
+    for (int i = 0; i < VEHICLE_COUNT; i++)
+    {
+        char vID;
+        do
+        {
+            vID = 'A' + (char)(eng() % 26);
+        } while (usedIDs.find(vID) != usedIDs.end());
+        usedIDs.insert(vID);
+
+        vehicleIDs[i] = vID;
+        parkingSpaces[i] = allSpaces[i]; // 取前20
+    }
+    if (baseLot.isUsingStallAssignment())
+        baseLot.orderByAssignment(parkingSpaces);
+
+    // 建立 Original / Improved
+    // baseLot 設了 SIPP (--sipp) 時只套用在改良組，傳統組維持原本的 A*
+    ParkingLot parkingLotOriginal = baseLot;
+    parkingLotOriginal.setUseImprovedAStar(false);
+    parkingLotOriginal.setUseSipp(false);
+
+    ParkingLot parkingLotImproved = baseLot;
+    parkingLotImproved.setUseImprovedAStar(true);
+
+    // 先執行「傳統 A*」
+    if (verbose)
+        cout << "=== Traditional A* Execution ===\n";
+    runExperiment(parkingLotOriginal, log, realtime, vehicleIDs, parkingSpaces);
+
+    // 再執行「改良 A*」
+    if (verbose)
+        cout << (parkingLotImproved.isUsingSipp() ? "\n=== Improved A* Execution (SIPP) ===\n"
+                                                  : "\n=== Improved A* Execution ===\n");
+    runExperiment(parkingLotImproved, log, realtime, vehicleIDs, parkingSpaces);
+
+    auto timesOrig = parkingLotOriginal.getVehicleTimes();
+    auto delayOrig = parkingLotOriginal.getDelayTime();
+    auto timesImpr = parkingLotImproved.getVehicleTimes();
+    auto delayImpr = parkingLotImproved.getDelayTime();
+
+    // 分別計算「前10 與 後10」
+    // 這裡 "前10" => vehicleIndex < 10; "後10" => vehicleIndex>=10
+    const int FRONT = VEHICLE_COUNT / 2;
+    FrontBackStats tTime = splitFrontBack(timesOrig, FRONT), tDelay = splitFrontBack(delayOrig, FRONT);
+    FrontBackStats iTime = splitFrontBack(timesImpr, FRONT), iDelay = splitFrontBack(delayImpr, FRONT);
+    RunResult res;
+    res.tfrontTime = tTime.frontMean();
+    res.tbackTime = tTime.backMean();
+    res.tfrontDelay = tDelay.frontMean();
+    res.tbackDelay = tDelay.backMean();
+    res.ifrontTime = iTime.frontMean();
+    res.ibackTime = iTime.backMean();
+    res.ifrontDelay = iDelay.frontMean();
+    res.ibackDelay = iDelay.backMean();
+
+    if (summary)
+    {
+        summary->addVehicles(timesOrig, timesImpr, BatchSummary::VEHICLE_TTIME);
+        summary->addVehicles(delayOrig, delayImpr, BatchSummary::VEHICLE_TDELAY);
+        summary->addRun(res);
+    }
+    return res;
+}
+
+// ----------------------------------------------------------------------
+// results CSV：欄位與 results_cleaned_forPAPER.csv 相同
+//   Batch = ceil(RunID / 20)；*_pct = (trad - impr) / trad * 100，trad 為 0 時留空
+// ----------------------------------------------------------------------
+static const char *RESULT_CSV_HEADER =
+    "Batch,RunID,tfront_time,tback_time,tfront_delay,tback_delay,ifront_time,iback_time,"
+    "ifront_delay,iback_delay,front_time_pct,back_time_pct,front_delay_pct,back_delay_pct";
+
+// 最短可還原的十進位表示 (與 Python 寫出的 "22.7"、"0.0" 相同)
+string formatCsvNumber(double v)
+{
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    string s(buf, res.ptr);
+    if (s.find_first_of(".eni") == string::npos)
+        s += ".0";
+    return s;
+}
+
+string formatPct(double trad, double impr)
+{
+    if (trad == 0.0)
+        return "";
+    return formatCsvNumber((trad - impr) / trad * 100.0);
+}
+
+string formatResultRow(long long runId, const RunResult &r)
+{
+    string row = to_string((runId + 19) / 20) + ',' + to_string(runId);
+    for (double v : {r.tfrontTime, r.tbackTime, r.tfrontDelay, r.tbackDelay,
+                     r.ifrontTime, r.ibackTime, r.ifrontDelay, r.ibackDelay})
+    {
+        row += ',' + formatCsvNumber(v);
+    }
+    row += ',' + formatPct(r.tfrontTime, r.ifrontTime);
+    row += ',' + formatPct(r.tbackTime, r.ibackTime);
+    row += ',' + formatPct(r.tfrontDelay, r.ifrontDelay);
+    row += ',' + formatPct(r.tbackDelay, r.ibackDelay);
+    row += '\n';
+    return row;
+}
+
+// 批次結束時印出 BatchSummary (平均 ± 95% CI、標準差、百分位數)
+void printBatchSummary(const BatchSummary &s, double ms)
+{
+    char line[160];
+    cout << "\n=== Summary (streaming, " << s.columns[BatchSummary::T_FRONT_TIME].stats.count() << " runs, "
+         << ms << " ms) ===\n";
+    snprintf(line, sizeof(line), "%-20s %9s %10s %9s %9s %9s %9s %9s %9s\n", "column", "n", "mean", "+-95%CI",
+             "sd", "p5", "p50", "p95", "max");
+    cout << line;
+    for (int c = 0; c < BatchSummary::COLUMN_COUNT; c++)
+    {
+        const StreamSummary &col = s.columns[c];
+        if (c == BatchSummary::T_FRONT_TIME || c == BatchSummary::FRONT_TIME_PCT ||
+            c == BatchSummary::FRONT_TIME_DIFF || c == BatchSummary::VEHICLE_TTIME)
+            cout << "\n";
+        snprintf(line, sizeof(line), "%-20s %9llu %10.3f %9.3f %9.3f %9.2f %9.2f %9.2f %9.2f\n",
+                 BatchSummary::name(c), (unsigned long long)col.stats.count(), col.stats.mean(),
+                 col.stats.ci95HalfWidth(), col.stats.stddev(), col.hist.percentile(5), col.hist.percentile(50),
+                 col.hist.percentile(95), col.stats.max());
+        cout << line;
+    }
+}
+
+// --summary FILE：每欄一列 (沒有資料的欄位數值留空)
+//   數值取 10 位有效數字：合併順序不同只會差在最後幾個位元，不影響輸出
+bool writeBatchSummary(const string &path, const BatchSummary &s)
+{
+    char num[32];
+    ofstream out(path);
+    if (!out)
+        return false;
+    out << "column,n,mean,sd,ci95_low,ci95_high,min,p5,p25,p50,p75,p95,max\n";
+    for (int c = 0; c < BatchSummary::COLUMN_COUNT; c++)
+    {
+        const StreamSummary &col = s.columns[c];
+        out << BatchSummary::name(c) << ',' << col.stats.count();
+        if (col.stats.count() == 0)
+        {
+            out << ",,,,,,,,,,,\n";
+            continue;
+        }
+        double half = col.stats.ci95HalfWidth();
+        for (double v : {col.stats.mean(), col.stats.stddev(), col.stats.mean() - half, col.stats.mean() + half,
+                         col.stats.min(), col.hist.percentile(5), col.hist.percentile(25), col.hist.percentile(50),
+                         col.hist.percentile(75), col.hist.percentile(95), col.stats.max()})
+        {
+            out << ',';
+            if (!std::isnan(v))
+            {
+                snprintf(num, sizeof(num), "%.10g", v);
+                out << num;
+            }
+        }
+        out << '\n';
+    }
+    return (bool)out;
+}
+
+// --route-cache 的命中率與省下的規劃時間 (未命中的平均耗時 - 命中的平均耗時) × 命中次數
+void printRouteCacheStats(const RouteCache *cache)
+{
+    if (!cache)
+        return;
+    RouteCache::Stats s = cache->stats();
+    double hitUs = s.hits ? s.hitNanos / 1000.0 / s.hits : 0.0;
+    double missUs = s.misses() ? s.missNanos / 1000.0 / s.misses() : 0.0;
+    cout << "[route cache] lookups=" << s.lookups << ", hits=" << s.hits << " ("
+         << (s.lookups ? 100.0 * s.hits / s.lookups : 0.0) << "%), stale=" << s.stale << ", avg hit=" << hitUs
+         << " us, avg miss=" << missUs << " us, saved~" << s.hits * max(missUs - hitUs, 0.0) / 1000.0 << " ms\n";
+}
+
+// --search-stats FILE：匯出每次搜尋的計數 (以 -DSEARCH_STATS=ON 編譯才有資料)
+void exportSearchStats(const string &path)
+{
+    if (path.empty())
+        return;
+    if (!SearchStats::enabled())
+    {
+        cout << "--search-stats ignored: built without SEARCH_STATS (cmake -DSEARCH_STATS=ON)\n";
+        return;
+    }
+    if (!SearchStats::exportFile(path))
+    {
+        cout << "Cannot write " << path << "\n";
+        return;
+    }
+    cout << "Search stats: " << SearchStats::count() << " searches => " << path << "\n";
+}
+
+// ----------------------------------------------------------------------
+// runBatch：N 個獨立實驗丟進 work-stealing pool，完成一列就寫一列
+//   RunID = firstRun .. firstRun+N-1，run 的 seed = deriveRunSeed(baseSeed, RunID)
+//   每個 worker 各自累計 BatchSummary (不需要鎖)，結束後合併印出；summaryPath 不為空時另存 CSV
+// ----------------------------------------------------------------------
+int runBatch(const ParkingLot &baseLot, const vector<pair<int, int>> &allSpaces, long long runs,
+             long long firstRun, unsigned threads, unsigned long long baseSeed, const string &outPath,
+             const string &summaryPath)
+{
+    ofstream out(outPath, ios::app);
+    if (!out)
     {
-        if (vt.vehicleIndex >= beginIdx && vt.vehicleIndex < endIdx)
+        cout << "Cannot open " << outPath << "\n";
+        return 1;
+    }
+    if (out.tellp() == 0)
+        out << RESULT_CSV_HEADER << '\n';
+
+    mutex outMtx;
+    auto t0 = steady_clock::now();
+    unsigned long long stolen = 0;
+    vector<BatchSummary> perWorker;
+    {
+        WorkStealingPool pool(threads);
+        threads = pool.size();
+        perWorker.resize(threads);
+        for (long long runId = firstRun; runId < firstRun + runs; runId++)
         {
-            sum += vt.time;
-            count++;
+            pool.submit([&, runId]()
+                        {
+                            RunLog log{to_string(runId)};
+                            SEARCH_STAT(SearchStats::setRun(log.runId));
+                            BatchSummary &summary = perWorker[WorkStealingPool::workerIndex()];
+                            RunResult res = runComparison(baseLot, allSpaces, deriveRunSeed(baseSeed, runId),
+                                                          log, false, false, &summary);
+                            string row = formatResultRow(runId, res);
+                            lock_guard<mutex> lock(outMtx);
+                            out << row; });
         }
+        pool.wait();
+        stolen = pool.stolenTasks();
     }
-    return (count > 0) ? (double)sum / count : 0.0;
+    double secs = duration<double>(steady_clock::now() - t0).count();
+
+    cout << "Batch: " << runs << " runs (RunID " << firstRun << ".." << firstRun + runs - 1
+         << ") on " << threads << " threads in " << secs << " s (" << (secs > 0 ? runs / secs : 0.0)
+         << " runs/s, " << stolen << " stolen) => " << outPath << "\n";
+    SearchContext::Totals st = SearchContext::totals();
+    cout << "Searches: " << st.searches << ", expansions/query="
+         << (st.searches ? (double)st.expansions / st.searches : 0.0) << "\n";
+    printRouteCacheStats(baseLot.getRouteCache());
+
+    auto m0 = steady_clock::now();
+    BatchSummary summary;
+    for (auto &s : perWorker)
+        summary.merge(s);
+    printBatchSummary(summary, duration<double, milli>(steady_clock::now() - m0).count());
+    if (!summaryPath.empty())
+    {
+        if (writeBatchSummary(summaryPath, summary))
+            cout << "Summary => " << summaryPath << "\n";
+        else
+            cout << "Cannot write " << summaryPath << "\n";
+    }
+    return 0;
 }
 
 // ----------------------------------------------------------------------
 // 在 main 中執行：
 //   1) 建立 baseLot => Setting
-//   2) 產生 vehicleIDs + spaces, 確保隨機位置不重複
-//   3) parkingLotOriginal、parkingLotImproved
-//   4) Each => addVehicle(..., index)
-//   5) Print front10 / last10
+//   2) 收集所有 PARKING_SPACE
+//   3) 單次：runComparison + Print front10 / last10
+//      批次：runBatch => results CSV
+// 參數：[runId] [--seed N] [--realtime] [--sipp] [--alt] [--jps] [--route-cache] [--search-stats FILE] [--assign]
+//       [--render ansi|plain|headless] [--fps N] [--trace FILE]
+//       --batch N [--threads T] [--first-run R] [--out results.csv] [--summary FILE] [--seed BASE]
+//   預設為 virtual 時鐘 (毫秒內跑完)；--realtime 以真實秒數逐秒執行
+//   --sipp：改良組改用 reservation table + SIPP (CSV 欄位不變)
+//   --alt：兩組 A* 都改用 ALT landmark heuristic (取代 Manhattan)
+//   --jps：兩組 A* 都沿直線通道跳到下一個決策點，遇到 waitTime 懲罰或行駛中的車輛時逐格展開
+//          (路徑成本不變，但等長路線的選擇不同，模擬結果會與不加 --jps 不同)
+//          傳統組的結果也會改變，不能當作傳統 / 改良比較的基準 => 不能與 --batch 一起使用
+//   --route-cache：A* 結果依 (起點, 終點, 模式) 快取，讀過的區塊改變即失效；結束時印出命中率
+//   --search-stats FILE：每次 A* 的計數寫成 CSV (.json => JSON)，run 欄位 = RunID
+//   --assign：抽到的 20 個車位以距離場 + 最小成本指派分給 20 台車 (預設依抽到的順序)
+//   --render：單次執行的地圖畫面 (ansi = 只重畫變動的格子、plain = 整張文字、headless = 不輸出)，
+//             在自己的執行緒上以 --fps (預設 10) 更新；預設 --realtime 時 ansi，否則 headless；批次模式不輸出
+//   --trace：單次執行的逐 tick 軌跡，兩組各寫一份 (FILE.traditional / FILE.improved，插在副檔名前)；
+//            以 trace_replay 檢視，批次模式忽略
+//   --summary：批次執行時即時累計的統計 (平均、標準差、95% CI、百分位數，含兩組的配對差) 另存成 CSV；
+//              不論有沒有 --summary，批次結束都會印出同一份表
 // ----------------------------------------------------------------------
 int main(int argc, char *argv[])
 {
-    srand((unsigned)time(nullptr));
-
-    if (argc > 1)
+    bool realtime = false;
+    bool sipp = false;
+    bool alt = false;
+    bool jps = false;
+    bool routeCache = false;
+    bool assign = false;
+    unsigned seed = std::random_device{}();
+    string runId;
+    long long batchRuns = 0;
+    long long firstRun = 1;
+    unsigned threads = 0;
+    string outPath = "results.csv";
+    string layoutPath, saveLayoutPath;
+    string searchStatsPath;
+    string renderArg;
+    int fps = 10;
+    string tracePath;
+    string summaryPath;
+    for (int a = 1; a < argc; a++)
     {
-        g_runId = argv[1];
+        string arg = argv[a];
+        if (arg == "--realtime")
+        {
+            realtime = true;
+        }
+        else if (arg == "--sipp")
+        {
+            sipp = true;
+        }
+        else if (arg == "--alt")
+        {
+            alt = true;
+        }
+        else if (arg == "--jps")
+        {
+            jps = true;
+        }
+        else if (arg == "--route-cache")
+        {
+            routeCache = true;
+        }
+        else if (arg == "--assign")
+        {
+            assign = true;
+        }
+        else if (arg == "--seed" && a + 1 < argc)
+        {
+            seed = (unsigned)stoul(argv[++a]);
+        }
+        else if (arg == "--batch" && a + 1 < argc)
+        {
+            batchRuns = stoll(argv[++a]);
+        }
+        else if (arg == "--threads" && a + 1 < argc)
+        {
+            threads = (unsigned)stoul(argv[++a]);
+        }
+        else if (arg == "--first-run" && a + 1 < argc)
+        {
+            firstRun = stoll(argv[++a]);
+        }
+        else if (arg == "--out" && a + 1 < argc)
+        {
+            outPath = argv[++a];
+        }
+        else if (arg == "--layout" && a + 1 < argc)
+        {
+            layoutPath = argv[++a];
+        }
+        else if (arg == "--save-layout" && a + 1 < argc)
+        {
+            saveLayoutPath = argv[++a];
+        }
+        else if (arg == "--search-stats" && a + 1 < argc)
+        {
+            searchStatsPath = argv[++a];
+        }
+        else if (arg == "--render" && a + 1 < argc)
+        {
+            renderArg = argv[++a];
+        }
+        else if (arg == "--fps" && a + 1 < argc)
+        {
+            fps = stoi(argv[++a]);
+        }
+        else if (arg == "--trace" && a + 1 < argc)
+        {
+            tracePath = argv[++a];
+        }
+        else if (arg == "--summary" && a + 1 < argc)
+        {
+            summaryPath = argv[++a];
+        }
+        else
+        {
+            runId = arg;
+        }
     }
-    else
+    if (runId.empty())
     {
-        g_runId = to_string(time(nullptr));
+        runId = to_string(time(nullptr));
     }
+    LotRenderer::Mode renderMode = realtime ? LotRenderer::Mode::Ansi : LotRenderer::Mode::Headless;
+    if (!renderArg.empty() && !LotRenderer::parseMode(renderArg, renderMode))
+    {
+        cout << "Bad --render value (expected ansi, plain or headless): " << renderArg << "\n";
+        return 1;
+    }
+    cout << "Seed: " << seed << (realtime ? " (realtime)" : " (virtual clock)") << "\n";
     g_assignmentFile.open("vehicle_assignments.csv", ios::app);
 
     ParkingLot baseLot;
+    baseLot.setUseSipp(sipp);
+    baseLot.setUseJps(jps);
+    baseLot.setUseStallAssignment(assign);
+    if (routeCache)
+        baseLot.enableRouteCache();
 
     // 設定地圖(同你給的例子)
     baseLot.addCell(0, 0, WALL);
@@ -619,142 +1519,96 @@ int main(int argc, char *argv[])
         }
     }
 
-    // 先收集「所有 PARKING_SPACE」
-    vector<pair<int, int>> allSpaces;
+    // --layout：以檔案取代上面的內建地圖
+    if (!layoutPath.empty())
     {
-        auto &grid = baseLot.getParkingLot();
-        for (int r = 0; r < (int)grid.size(); r++)
+        LotLayout layout;
+        string err;
+        auto t0 = chrono::steady_clock::now();
+        if (!loadLotLayout(layoutPath, layout, err))
         {
-            for (int c = 0; c < (int)grid[0].size(); c++)
-            {
-                if (grid[r][c].type == PARKING_SPACE)
-                {
-                    allSpaces.emplace_back(r, c);
-                }
-            }
+            cerr << "Failed to load layout: " << err << "\n";
+            return 1;
         }
+        baseLot.loadLayout(layout);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        cout << "Layout " << layoutPath << ": " << layout.rows << "x" << layout.cols << ", "
+             << layout.stallCount() << " stalls, " << layout.entrances.size() << " entrance(s), loaded in "
+             << ms << " ms\n";
     }
-
-    // 若可用車位 < 20 => break
-    int vehicleCount = 20;
-    if ((int)allSpaces.size() < vehicleCount)
+    if (!saveLayoutPath.empty())
     {
-        cout << "Not enough parking spaces => can't place 20 vehicles.\n";
-        return 0;
+        if (!saveLotLayout(saveLayoutPath, baseLot.toLayout()))
+        {
+            cerr << "Failed to write layout " << saveLayoutPath << "\n";
+            return 1;
+        }
+        cout << "Layout saved to " << saveLayoutPath << "\n";
     }
 
-    // 打亂 => 取得前 20 個
-    std::random_device rd;
-    std::default_random_engine eng(rd());
-    std::shuffle(allSpaces.begin(), allSpaces.end(), eng);
-
-    vector<char> vehicleIDs(vehicleCount);
-    vector<pair<int, int>> parkingSpaces(vehicleCount);
-
-    // 產生 20 個不重複車位
-    // 也產生 20 個不重複的 vehicleID
-    unordered_set<char> usedIDs;
-    for (int i = 0; i < vehicleCount; i++)
+    if (alt)
     {
-        char vID;
-        do
-        {
-            vID = 'A' + (rand() % 26);
-        } while (usedIDs.find(vID) != usedIDs.end());
-        usedIDs.insert(vID);
-
-        vehicleIDs[i] = vID;
-        parkingSpaces[i] = allSpaces[i]; // 取前20
+        size_t n = baseLot.enableLandmarks();
+        cout << "ALT heuristic: " << n << " landmarks\n";
     }
 
-    // 建立 Original / Improved
-    ParkingLot parkingLotOriginal = baseLot;
-    parkingLotOriginal.setUseImprovedAStar(false);
-
-    ParkingLot parkingLotImproved = baseLot;
-    parkingLotImproved.setUseImprovedAStar(true);
-
-    // 先執行「傳統 A*」
-    cout << "=== Traditional A* Execution ===\n";
+    // 先收集「所有 PARKING_SPACE」
+    vector<pair<int, int>> allSpaces;
     {
-        vector<thread> ths;
-        for (int i = 0; i < vehicleCount; i++)
-        {
-            char vID = vehicleIDs[i];
-            auto ps = parkingSpaces[i];
-            // 執行 addVehicle( row, col, vID, i )
-            ths.emplace_back([&](char id, int r, int c, int idx)
-                             { addVehicleLogged(parkingLotOriginal, id, r, c, idx); }, vID, ps.first, ps.second, i);
-
-            this_thread::sleep_for(std::chrono::seconds(2));
-        }
-        for (auto &th : ths)
-        {
-            th.join();
-        }
+        baseLot.getParkingLot().forEachOfType(PARKING_SPACE, [&](int r, int c)
+                                              { allSpaces.emplace_back(r, c); });
     }
 
-    // 取結果
-    auto timesOrig = parkingLotOriginal.getVehicleTimes();
-    auto delayOrig = parkingLotOriginal.getDelayTime();
-
-    // 再執行「改良 A*」
-    cout << "\n=== Improved A* Execution ===\n";
+    // 若可用車位 < 20 => break
+    if ((int)allSpaces.size() < VEHICLE_COUNT)
     {
-        vector<thread> ths;
-        for (int i = 0; i < vehicleCount; i++)
-        {
-            char vID = vehicleIDs[i];
-            auto ps = parkingSpaces[i];
-            ths.emplace_back([&](char id, int r, int c, int idx)
-                             { addVehicleLogged(parkingLotImproved, id, r, c, idx); }, vID, ps.first, ps.second, i);
-
-            this_thread::sleep_for(std::chrono::seconds(2));
-        }
-        for (auto &th : ths)
-        {
-            th.join();
-        }
+        cout << "Not enough parking spaces => can't place 20 vehicles.\n";
+        return 0;
     }
 
-    auto timesImpr = parkingLotImproved.getVehicleTimes();
-    auto delayImpr = parkingLotImproved.getDelayTime();
-
-    // 分別計算「前10 與 後10」
-    // 這裡 "前10" => vehicleIndex < 10; "後10" => vehicleIndex>=10
-    auto calcAvgByIndexRange = [&](const vector<VehicleTime> &arr, int startIndex, int endIndex)
+    if (batchRuns > 0)
     {
-        long long sum = 0;
-        int count = 0;
-        for (auto &vt : arr)
+        if (jps)
         {
-            if (vt.vehicleIndex >= startIndex && vt.vehicleIndex < endIndex)
-            {
-                sum += vt.time;
-                count++;
-            }
+            cerr << "--jps changes the traditional arm's routes; it cannot be used with --batch.\n";
+            return 1;
         }
-        return (count > 0) ? (double)sum / count : 0.0;
-    };
-
-    double frontTimeOrig = calcAvgByIndexRange(timesOrig, 0, 10);
-    double backTimeOrig = calcAvgByIndexRange(timesOrig, 10, 20);
-
-    double frontDelayOrig = calcAvgByIndexRange(delayOrig, 0, 10);
-    double backDelayOrig = calcAvgByIndexRange(delayOrig, 10, 20);
-
-    double frontTimeImpr = calcAvgByIndexRange(timesImpr, 0, 10);
-    double backTimeImpr = calcAvgByIndexRange(timesImpr, 10, 20);
-
-    double frontDelayImpr = calcAvgByIndexRange(delayImpr, 0, 10);
-    double backDelayImpr = calcAvgByIndexRange(delayImpr, 10, 20);
-
-    cout << "\n=== Results (Front10 / Back10) ===\n";
-    cout << "(Traditional A*) front10 time=" << frontTimeOrig << ", back10 time=" << backTimeOrig << "\n";
-    cout << "(Traditional A*) front10 delay=" << frontDelayOrig << ", back10 delay=" << backDelayOrig << "\n\n";
+        if (realtime)
+            cout << "--realtime is ignored in batch mode.\n";
+        if (!tracePath.empty())
+            cout << "--trace is ignored in batch mode.\n";
+        int rc = runBatch(baseLot, allSpaces, batchRuns, firstRun, threads, seed, outPath, summaryPath);
+        exportSearchStats(searchStatsPath);
+        g_assignmentFile.close();
+        return rc;
+    }
 
-    cout << "(Improved A*) front10 time=" << frontTimeImpr << ", back10 time=" << backTimeImpr << "\n";
-    cout << "(Improved A*) front10 delay=" << frontDelayImpr << ", back10 delay=" << backDelayImpr << "\n";
+    if (!summaryPath.empty())
+        cout << "--summary is ignored without --batch.\n";
+    RunLog log{runId};
+    SEARCH_STAT(SearchStats::setRun(runId));
+    // 地圖畫面：兩組實驗的每個 tick 結束時交出一份快照，輸出在 renderer 的執行緒上
+    LotRenderer renderer(renderMode, fps);
+    baseLot.setRenderer(&renderer);
+    baseLot.setTracePath(tracePath);
+    RunResult r = runComparison(baseLot, allSpaces, seed, log, realtime, true);
+    renderer.stop(); // 畫完最後一個畫面，之後的統計照一般輸出
+
+    cout << "\n=== Results (Front10 / Back10)" << (jps ? ", --jps: not comparable with plain A* runs" : "")
+         << " ===\n";
+    cout << "(Traditional A*) front10 time=" << r.tfrontTime << ", back10 time=" << r.tbackTime << "\n";
+    cout << "(Traditional A*) front10 delay=" << r.tfrontDelay << ", back10 delay=" << r.tbackDelay << "\n\n";
+
+    cout << "(Improved A*) front10 time=" << r.ifrontTime << ", back10 time=" << r.ibackTime << "\n";
+    cout << "(Improved A*) front10 delay=" << r.ifrontDelay << ", back10 delay=" << r.ibackDelay << "\n";
+
+    SearchContext::Totals st = SearchContext::totals();
+    cout << "\n[search workspace] searches=" << st.searches << ", expansions=" << st.expansions << " ("
+         << (st.searches ? (double)st.expansions / st.searches : 0.0) << "/query, "
+         << (alt ? "ALT" : "Manhattan") << "), allocations=" << st.allocations
+         << ", avoided allocations~" << st.avoidedAllocations << " (" << st.avoidedBytes / 1024 << " KB)\n";
+    printRouteCacheStats(baseLot.getRouteCache());
+    exportSearchStats(searchStatsPath);
 
     cin.get();
 
@@ -7,6 +7,7 @@
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <unordered_set>
@@ -14,248 +15,645 @@
 #include <algorithm>
 #include <condition_variable>
 #include <map>
+#include <unordered_map>
 #include <functional> // 新增此行以使用 std::function
+#include <memory>
+#include <string>
+#include <deque>
+
+#include "closure_index.hpp"
+#include "dstar_lite.hpp"
+#include "grid_astar.hpp"
+#include "landmarks.hpp"
+#include "lot_grid.hpp"
+#include "lot_layout.hpp"
+#include "lot_renderer.hpp"
+#include "node_pool.hpp"
+#include "path_cursor.hpp"
+#include "replan_dispatcher.hpp"
+#include "route_cache.hpp"
+#include "search_context.hpp"
+#include "search_stats.hpp"
+#include "sim_clock.hpp"
+#include "stall_assignment.hpp"
+#include "stall_index.hpp"
+#include "trace_log.hpp"
+#include "vehicle_table.hpp"
 
 using namespace std;
 using namespace std::chrono;
 
 enum CellType { ENTRANCE, AISLE, WALL, PARKING_SPACE, VEHICLE, CLOSED_AISLE };
 
-struct Cell {
-    int row, col;
-    CellType type;
-    int waitTime = 0;
-    char vehicleID;
-    bool isMoving = true;
-    Cell(int r = 0, int c = 0, CellType t = AISLE) : row(r), col(c), type(t) {}
-};
-
 struct VehicleTime {
-    char vehicleID;
+    VehicleId vehicleID;
     long long time;
-    VehicleTime(char id, long long t) : vehicleID(id), time(t) {}
+    VehicleTime(VehicleId id, long long t) : vehicleID(id), time(t) {}
 };
 
 class ParkingLot {
 public:
+    // 內建地圖的大小；--layout 載入的地圖以 rows / cols 為準
     static const int MAX_ROWS = 17;
     static const int MAX_COLS = 24;
 
-    // 全域事件相關
-    static atomic<bool> eventTriggered;
-    static int closedCellRow;
-    static int closedCellCol;
-    static mutex replanMtx;
-
+    // 受影響車輛的重規劃紀錄 (move-only，路徑只搬移不複製)
     struct AffectedVehicleInfo {
-        char vehicleID;
+        VehicleId vehicleID;
         vector<pair<int,int>> remainingPath;
         int remainingLen;
         pair<int,int> currentPos; 
         int endRow;
         int endCol;
-
-        AffectedVehicleInfo(char v, const vector<pair<int,int>>& p, int l, pair<int,int> c, int er, int ec)
-            : vehicleID(v), remainingPath(p), remainingLen(l), currentPos(c), endRow(er), endCol(ec) {}
+        bool goalOk = true;              // 終點附近找得到通道
+        bool found = false;              // worker 規劃結果
+        vector<pair<int,int>> newPath;
+
+        AffectedVehicleInfo(VehicleId v, vector<pair<int,int>> p, int l, pair<int,int> c, int er, int ec)
+            : vehicleID(v), remainingPath(std::move(p)), remainingLen(l), currentPos(c), endRow(er), endCol(ec) {}
+        AffectedVehicleInfo(AffectedVehicleInfo&&) = default;
+        AffectedVehicleInfo& operator=(AffectedVehicleInfo&&) = default;
+        AffectedVehicleInfo(const AffectedVehicleInfo&) = delete;
+        AffectedVehicleInfo& operator=(const AffectedVehicleInfo&) = delete;
     };
 
-    static vector<AffectedVehicleInfo> affectedVehicles;
-    static condition_variable replanCV;
+    // 剩餘路徑短的先重規劃 (與原本 sort by remainingLen 相同)
+    struct ShorterRemaining {
+        bool operator()(const AffectedVehicleInfo& a, const AffectedVehicleInfo& b) const {
+            return a.remainingLen < b.remainingLen;
+        }
+    };
+    using Replanner = ReplanDispatcher<AffectedVehicleInfo, ShorterRemaining>;
 
 private:
-    Cell parkingLot[MAX_ROWS][MAX_COLS];
+    // 地圖狀態：type / waitTime / vehicleID 各自一個平面，isMoving 與可通行為 bitboard
+    LotGrid parkingLot;
+    int rows = MAX_ROWS, cols = MAX_COLS;
+
+    // 可通行規則 (LotGrid pass class)，建構時依序定義
+    static constexpr int PASS_DRIVE = 0;  // isCellValid：通道、入口，或正在移動的車輛
+    static constexpr int PASS_ROUTE = 1;  // aStarWithReturn：牆、車位、CLOSED_AISLE 以外
+    static constexpr int PASS_STATIC = 2; // ALT：牆與 CLOSED_AISLE 以外
+    // 進場入口與離場出口 (內建地圖皆為 (0,8))；有多個時選離車位最近的
+    vector<pair<int,int>> entrances{{0, 8}};
+    vector<pair<int,int>> exits{{0, 8}};
+    // 車位索引：空車位 (PARKING_SPACE) 與停著車的車位，隨 assignType 更新，挑車位不再掃整張地圖
+    FreeStallIndex freeStalls;
+    CellSet parkedStalls;
+    int nearestStallChoices = 0; // --nearest-stall K：從離入口最近的 K 個空車位中挑
+    // --assign-wave N：每 N 台進場車一起指派車位，這一波還沒進場的車依抵達順序排在 waveStalls
+    int arrivalWave = 0;
+    deque<pair<int,int>> waveStalls;
+    static constexpr int PARK_TICKS = 10; // 倒車 parkCountdown 9..0
     vector<VehicleTime> vehicleTimes;
     mutex mtx;
-    atomic<long long> lastDisplayTime;
-    map<char, pair<int,int>> vehicleDestinations;
+    LotRenderer *renderer = nullptr; // --render：地圖畫面 (預設 headless)
+    TraceWriter *trace = nullptr;    // --trace：逐 tick 的軌跡
+    SimClock *clock = nullptr;
+    atomic<int> activeMoves{0};
+    unique_ptr<LandmarkHeuristic> landmarks; // --alt 時才建立
+    unique_ptr<RouteCache> routeCache;       // --route-cache 時才建立
+
+    // --incremental：每台車一份 D* Lite，封閉通道後只修補受影響的部分
+    bool useIncremental = false;
+    vector<uint8_t> topoBlocked; // 牆、車位、CLOSED_AISLE
+    uint64_t incrementalPlans = 0;
+    uint64_t incrementalInitialExpansions = 0;
+    atomic<uint64_t> incrementalReplans{0};          // 由 replan worker 累加
+    atomic<uint64_t> incrementalReplanExpansions{0};
+
+    // 重規劃派工：受影響車輛送進 priority queue，同一 tick 結束前平行規劃完
+    unique_ptr<Replanner> replanner;
+    bool replanFlushScheduled = false;
+
+    bool isTopoBlocked(int r, int c) const {
+        return !parkingLot.passable(PASS_ROUTE, r, c);
+    }
+
+    // 路線規劃完成後建立這台車的 D* Lite (從起點做一次完整的反向搜尋)
+    void trackIncremental(VehicleId vehicleID, pair<int,int> from, pair<int,int> to) {
+        if (!useIncremental) return;
+        unique_ptr<DStarLite> planner(new DStarLite(rows, cols, &topoBlocked, to.first, to.second));
+        planner->setStart(from.first, from.second);
+        planner->computeShortestPath();
+        incrementalPlans++;
+        incrementalInitialExpansions += planner->lastExpansions();
+        vehicles[vehicleID].planner = std::move(planner);
+    }
+
+    // 以 D* Lite 修補路線 (在 replan worker 上執行，只動這台車自己的 planner)
+    //   失敗時回傳 false，由呼叫端退回 A*
+    bool replanIncremental(AffectedVehicleInfo &avi) {
+        if (!vehicles[avi.vehicleID].planner) return false;
+        DStarLite &planner = *vehicles[avi.vehicleID].planner;
+        planner.setStart(avi.remainingPath[0].first, avi.remainingPath[0].second);
+        bool ok = planner.computeShortestPath();
+        incrementalReplans++;
+        incrementalReplanExpansions += planner.lastExpansions();
+        if (!ok || !planner.extractPath(avi.newPath)) return false;
+        avi.found = true;
+        return true;
+    }
+
+    // ALT 用的靜態可通行：車位也算可通行 (比 aStarWithReturn 寬鬆，距離表仍是下界)
+    bool isStaticPassable(int r, int c) const {
+        return parkingLot.passable(PASS_STATIC, r, c);
+    }
 
     // isCellValid需修改，以配合CLOSED_AISLE不可通行
     bool isCellValid(int row, int col) const {
-        return row >= 0 && row < MAX_ROWS && col >= 0 && col < MAX_COLS &&
-               (parkingLot[row][col].type == AISLE ||
-                (parkingLot[row][col].type == VEHICLE && parkingLot[row][col].isMoving) ||
-                parkingLot[row][col].type == ENTRANCE);
+        return parkingLot.passable(PASS_DRIVE, row, col);
     }
 
-    void moveVehicleImpl(vector<pair<int, int>>& path, char vehicleID) {
+    // 行駛狀態：由 SimClock 事件逐 tick 推進 (原本迴圈裡的 sleep_for(1s) = 等 1 tick)
+    enum MovePhase { STARTING, DRIVING, PARKING, FINISHED };
+
+    struct MoveState {
+        PathCursor path;                // 前進只移動游標，不搬動剩餘路徑
+        VehicleId vehicleID;
+        MovePhase phase = STARTING;
+        int parkCountdown = 9;
+        long long startTick = 0;
+        bool rerouteRequested = false; // 剩餘路線上有格子被封閉 (由 closeCell 通知)
+    };
+
+    // 封閉通道：bitmap + 「格子 -> 路線經過的車輛」反向索引，封閉時只通知受影響的車
+    ClosureMap closures;
+    RouteIndex routeIndex;
+    vector<uint8_t> closedBaseType; // 封閉前這格的底層 type，reopenCell 還原用
+
+    // 車輛表：以 VehicleId 直接索引，記錄角色、目的地、行駛狀態、D* Lite 與統計
+    struct VehicleInfo {
+        char label = '\0';                        // 原本的字母 ID (只用於輸出)
+        VehicleRole role = VehicleRole::Arriving;  // 取代原本的大寫 (進場) / 小寫 (離場)
+        bool hasDestination = false;
+        pair<int,int> destination{-1, -1};
+        MoveState *move = nullptr;                 // 行駛中 (含倒車) 時指向目前的 MoveState
+        unique_ptr<DStarLite> planner;             // --incremental
+        long long moveTime = -1;                   // 最後一段行駛花費的 tick
+        int replans = 0;
+    };
+    VehicleTable<VehicleInfo> vehicles;
+
+    void moveVehicleImpl(vector<pair<int, int>>& path, VehicleId vehicleID) {
         if (path.empty()) return;
-        auto startTime = steady_clock::now();
-
-        parkingLot[path.front().first][path.front().second].isMoving = true;
-
-        parkingLot[path[0].first][path[0].second].type = VEHICLE;
-        parkingLot[path[0].first][path[0].second].vehicleID = vehicleID;
-        parkingLot[path[0].first][path[0].second].isMoving = true;
-        int wtSum = 0;
-        for (size_t i = 0; i + 1 < path.size(); ++i) {
-            if(parkingLot[path[i].first][path[i].second].waitTime != 0){
-                int adj = parkingLot[path[i].first][path[i].second].waitTime - (int)i;
-                wtSum += std::max(adj, 0);
-            }
+        auto st = make_shared<MoveState>();
+        st->path.reset(path);
+        st->vehicleID = vehicleID;
+        activeMoves++;
+        vehicles[vehicleID].move = st.get();
+        routeIndex.assign(vehicleID, path);
+        // 之後每個 tick 由 SimClock 的 agent 批次推進一步
+        if (advanceMove(*st)) clock->addAgent([this, st]() { return advanceMove(*st); });
+    }
+
+    // 車輛結束這段行駛 (抵達或中斷重規劃)：從反向索引移除
+    void endMove(MoveState& st) {
+        st.phase = FINISHED;
+        if (trace) trace->vehicleGone(st.vehicleID);
+        routeIndex.remove(st.vehicleID);
+        vehicles[st.vehicleID].move = nullptr;
+        activeMoves--;
+    }
+
+    // 寫入 waitTime；由 0 變非 0 時通知路線經過這格的車 (PathCursor 只追蹤非 0 的格子)
+    void setWait(int r, int c, int w) {
+        bool wasZero = parkingLot.waitTime(r, c) == 0;
+        parkingLot.setWaitTime(r, c, w);
+        if (!wasZero || w == 0) return;
+        for (int v : routeIndex.vehiclesOn(r, c)) {
+            if (MoveState *mv = vehicles[(VehicleId)v].move) mv->path.markWaiting(r, c);
         }
-        parkingLot[path.back().first][path.back().second].waitTime = (int)path.size() + 9 + wtSum;
-
-        for (size_t i = 1; i < path.size();) {
-            if (parkingLot[path[i].first][path[i].second].isMoving) {
-                mtx.lock();
-                parkingLot[path[i - 1].first][path[i - 1].second].vehicleID = ' ';
-                parkingLot[path[i].first][path[i].second].vehicleID = vehicleID;
-                parkingLot[path[i - 1].first][path[i - 1].second].type = AISLE;
-                parkingLot[path[i - 1].first][path[i - 1].second].isMoving = true;
-                parkingLot[path[i].first][path[i].second].type = VEHICLE;
-                parkingLot[path[i].first][path[i].second].isMoving = true;
-                mtx.unlock();
-                path.erase(path.begin());
-            }
-            else{
-                parkingLot[path[i-1].first][path[i-1].second].isMoving = false;
-            }
+    }
 
-            int wtSum = 0;
-            for (size_t k = 0; k + 1 < path.size(); ++k) {
-                if(parkingLot[path[k].first][path[k].second].waitTime != 0){
-                int adj = parkingLot[path[k].first][path[k].second].waitTime - (int)k;
-                wtSum += std::max(adj, 0);
-                }
-            }
-            parkingLot[path.back().first][path.back().second].waitTime = (int)path.size() + 9 + wtSum;
-
-            this_thread::sleep_for(chrono::seconds(1));
-            displayStatus();
-
-            // 事件觸發檢查
-            if (eventTriggered.load()) {
-                // 檢查是否受影響
-                if (isVehicleAffectedByClosedCell(path)) {
-                    lock_guard<mutex> lk(replanMtx);
-                    // 在 moveVehicleImpl 偵測到事件並受影響處:
-                    auto it = vehicleDestinations.find(vehicleID);
-                    if (it != vehicleDestinations.end()) {
-                        int originalEndRow = it->second.first;
-                        int originalEndCol = it->second.second;
-                        affectedVehicles.emplace_back(vehicleID, path, (int)path.size(), path[0], originalEndRow, originalEndCol);
-                    } else {
-                        // 找不到目標位置的錯誤處理
-                    }
-                    return; // 中斷moveVehicle
+    int waitOf(int r, int c) const { return parkingLot.waitTime(r, c); }
+
+    // 依目前剩餘路徑重算終點 waitTime (只看剩餘路徑上等待中的格子)
+    void refreshDestinationWait(PathCursor& path) {
+        int wtSum = path.waitSum([this](int r, int c) { return waitOf(r, c); });
+        setWait(path.back().first, path.back().second, (int)path.size() + 9 + wtSum);
+    }
+
+    // 原本 for 迴圈裡「前進一格或停住」的部分
+    void stepOnce(MoveState& st) {
+        PathCursor& path = st.path;
+        if (parkingLot.moving(path[1].first, path[1].second)) {
+            // 這裡的模型允許行駛中的車重疊 (只有停住的車會擋路)，不適用單一 owner 的 CellOccupancy，
+            // 地圖寫入以 scoped lock 保護 (flush 期間 replan worker 只讀)
+            unique_lock<mutex> lk(mtx);
+            parkingLot.setOccupant(path[0].first, path[0].second, NO_VEHICLE);
+            parkingLot.setOccupant(path[1].first, path[1].second, st.vehicleID);
+            // 封閉時車正好停在這格 => 開走後維持 CLOSED_AISLE
+            parkingLot.setType(path[0].first, path[0].second,
+                               closures.isClosed(path[0].first, path[0].second) ? CLOSED_AISLE : AISLE);
+            parkingLot.setMoving(path[0].first, path[0].second, true);
+            parkingLot.setType(path[1].first, path[1].second, VEHICLE);
+            parkingLot.setMoving(path[1].first, path[1].second, true);
+            lk.unlock();
+            routeIndex.leave(st.vehicleID, path[0].first, path[0].second);
+            path.advance();
+            if (trace) trace->vehicleAt(st.vehicleID, path[0].first, path[0].second);
+        }
+        else{
+            lock_guard<mutex> stopLock(mtx);
+            parkingLot.setMoving(path[0].first, path[0].second, false);
+        }
+        refreshDestinationWait(path);
+    }
+
+    // 倒車的一秒
+    void parkOnce(MoveState& st) {
+        pair<int, int> last = st.path.back();
+        int j = st.parkCountdown--;
+        lock_guard<mutex> lk(mtx);
+        setWait(last.first, last.second, parkingLot.waitTime(last.first, last.second) - 1);
+        parkingLot.setMoving(last.first, last.second, false);
+        if (j == 0 || vehicles[st.vehicleID].role == VehicleRole::Departing){
+            st.parkCountdown = -1;
+            parkingLot.setType(last.first, last.second, closures.isClosed(last.first, last.second) ? CLOSED_AISLE : AISLE);
+            setWait(last.first, last.second, 0);
+            //parkingLot.setOccupant(last.first, last.second, NO_VEHICLE);
+            parkingLot.setMoving(last.first, last.second, true);
+        }
+    }
+
+    // 推進一個 tick；回傳 true => 需要再等 1 tick
+    bool advanceMove(MoveState& st) {
+        PathCursor& path = st.path;
+        VehicleId vehicleID = st.vehicleID;
+
+        switch (st.phase) {
+        case STARTING: {
+            st.startTick = clock->now();
+            parkingLot.setType(path[0].first, path[0].second, VEHICLE);
+            parkingLot.setOccupant(path[0].first, path[0].second, vehicleID);
+            parkingLot.setMoving(path[0].first, path[0].second, true);
+            if (trace) trace->vehicleAt(vehicleID, path[0].first, path[0].second);
+            int wtSum = path.rebuildWaits([this](int r, int c) { return waitOf(r, c); });
+            setWait(path.back().first, path.back().second, (int)path.size() + 9 + wtSum);
+            st.phase = DRIVING;
+            if (path.size() <= 1) break;
+            stepOnce(st);
+            return true;
+        }
+        case DRIVING:
+            // 事件觸發檢查：closeCell 已經透過反向索引標記受影響的車，不必再掃整條路徑
+            if (st.rerouteRequested) {
+                // 在 moveVehicle 偵測到事件並受影響處:
+                const VehicleInfo &info = vehicles[vehicleID];
+                if (info.hasDestination) {
+                    int originalEndRow = info.destination.first;
+                    int originalEndCol = info.destination.second;
+                    int remainingLen = (int)path.size();
+                    pair<int,int> currentPos = path[0];
+                    endMove(st);
+                    submitReplan(AffectedVehicleInfo(vehicleID, path.remaining(), remainingLen, currentPos,
+                                                     originalEndRow, originalEndCol));
+                } else {
+                    // 找不到目標位置的錯誤處理
+                    endMove(st);
                 }
+                return false; // 中斷moveVehicle
             }
 
-            if (path.size() == 1){
-                for (int j = 9; j >= 0; j--){
-                    parkingLot[path.back().first][path.back().second].waitTime--;
-                    parkingLot[path.back().first][path.back().second].isMoving = false;
-                    if (j == 0 || islower(vehicleID)){
-                        j = 0;
-                        parkingLot[path.back().first][path.back().second].type = AISLE;
-                        parkingLot[path.back().first][path.back().second].waitTime = 0;
-                        //parkingLot[path.back().first][path.back().second].vehicleID = ' ';
-                        parkingLot[path.back().first][path.back().second].isMoving = true;
-                    }
-                    this_thread::sleep_for(chrono::seconds(1));
-                    displayStatus();
-                }
+            if (path.size() == 1) {
+                st.phase = PARKING;
+                parkOnce(st);
+                return true;
+            }
+            stepOnce(st);
+            return true;
+        case PARKING:
+            if (st.parkCountdown >= 0) {
+                parkOnce(st);
+                return true;
             }
+            break;
+        case FINISHED:
+            return false;
         }
 
         lock_guard<mutex> lock(mtx);
-        auto endTime = steady_clock::now();
-        auto duration = duration_cast<seconds>(endTime - startTime).count();
-        vehicleTimes.emplace_back(vehicleID, duration);
+        VehicleInfo &info = vehicles[vehicleID];
+        info.moveTime = clock->now() - st.startTick;
+        info.planner.reset();
+        vehicleTimes.emplace_back(vehicleID, info.moveTime);
+        if (trace) trace->event(TraceEvent::Arrive, vehicleID, (uint32_t)info.moveTime);
+        endMove(st);
+        return false;
     }
 
     // 原本的aStar改用std::function作為參數
-    bool aStarWithReturn(int startRow, int startCol, int endRow, int endCol, char vehicleID,
+    bool aStarWithReturn(int startRow, int startCol, int endRow, int endCol, VehicleId vehicleID,
                          pair<int,int> noGoCell, bool allowUturn,
-                         std::function<void(vector<pair<int,int>>&, char)> moveVehicleCallback) {
-
-        struct Node {
-            int row, col, g, h;
-            vector<pair<int,int>> path;
-            int f() const { return g + h; }
-            bool operator>(const Node& other) const { return f() > other.f(); }
-        };
+                         std::function<void(vector<pair<int,int>>&, VehicleId)> moveVehicleCallback) {
+        // 只有進場車會避開其他車正在倒車的格子
+        bool avoidParking = vehicles[vehicleID].role == VehicleRole::Arriving;
+
+        // 每次搜尋的計數 (-DSEARCH_STATS=ON 時才編進來)；waitTime 懲罰只加在進場車上
+        SEARCH_STAT(SearchProbe probe(avoidParking ? "improved" : "traditional", vehicleID, startRow, startCol,
+                                      endRow, endCol));
+
+        // 路線快取：讀過的區塊都沒變 => 搜尋結果相同，直接沿用 (replan worker 也會同時查詢)
+        auto t0 = steady_clock::now();
+        RouteCache::Key key{startRow, startCol, endRow, endCol,
+                            plannerMode(avoidParking, allowUturn, noGoCell)};
+        RouteDeps *deps = nullptr;
+        if (routeCache) {
+            vector<pair<int,int>> cached;
+            if (routeCache->lookup(key, parkingLot, cached)) {
+                routeCache->addHitTime(elapsedNanos(t0));
+                SEARCH_STAT(probe.cached(cached.size()));
+                moveVehicleCallback(cached, vehicleID);
+                return true;
+            }
+            deps = &RouteDeps::local();
+            deps->begin(parkingLot);
+        }
 
         auto heuristic = [&](int sr, int sc, int er, int ec) {
+            if (landmarks) return landmarks->estimate(sr, sc, er, ec);
             return abs(er - sr) + abs(ec - sc);
         };
 
-        priority_queue<Node, vector<Node>, greater<Node>> pq;
-        vector<vector<int>> cost(MAX_ROWS, vector<int>(MAX_COLS, INT_MAX));
-        cost[startRow][startCol] = 0;
-        int hh = heuristic(startRow, startCol, endRow, endCol);
+        // 搜尋本身是 grid_astar.hpp 的共用核心 (與 250604statisticlog、astar_bench 相同)；
+        // 節點只記 parent 索引，找到終點才回溯出路徑；工作區每個執行緒一份、重複使用
+        AStarHooks hooks;
+        hooks.lot = this;
+        hooks.deps = deps;
+        hooks.noGoCell = allowUturn ? make_pair(-1, -1) : noGoCell;
+        SEARCH_STAT(hooks.probe = &probe);
+        GridAStarConfig cfg;
+        cfg.passClass = PASS_ROUTE;
+        cfg.improved = avoidParking; // waitTime 懲罰只加在進場車上
+        auto plainCell = [](int, int) { return false; }; // 沒有 JPS
+        vector<pair<int,int>> path;
+        int goalG = 0;
+        if (gridAStar(parkingLot, cfg, startRow, startCol, endRow, endCol, heuristic, plainCell, hooks, path, &goalG)) {
+            if (deps) {
+                routeCache->store(key, path, *deps);
+                routeCache->addMissTime(elapsedNanos(t0));
+            }
+            SEARCH_STAT(probe.finish(true, path.size(), goalG));
+            moveVehicleCallback(path, vehicleID);
+            return true;
+        }
+        if (deps) routeCache->addMissTime(elapsedNanos(t0));
+        cout << "No valid path found.\n";
+        return false;
+    }
 
-        {
-            Node startNode{startRow, startCol, 0, hh};
-            startNode.path.emplace_back(startRow, startCol);
-            pq.push(startNode);
+    // gridAStar 的 hooks：不可回頭的格子、--assign-wave 時停著車的車位，以及路線快取 / 搜尋計數
+    struct AStarHooks : SearchHooks {
+        const ParkingLot *lot = nullptr;
+        RouteDeps *deps = nullptr;
+        pair<int,int> noGoCell{-1, -1};
+        bool skip(int r, int c) const {
+            if (r == noGoCell.first && c == noGoCell.second) return true;
+            // --assign-wave：停著車 (或已被指派) 的車位也是 VEHICLE，但不會再動，穿過去會永遠卡在那裡；
+            // 一波車擠在最近的車位時特別常見，所以只在這個模式略過 (預設模式維持原本的展開規則)
+            return lot->usingArrivalWaves() && lot->parkedStalls.contains(lot->parkingLot.index(r, c));
         }
+        void visit(int r, int c) {
+            if (deps) deps->addCell(r, c);
+        }
+#ifdef SEARCH_STATS
+        SearchProbe *probe = nullptr;
+        void push() { probe->push(); }
+        void stalePop() { probe->stalePop(); }
+        void penalty(int extra) { probe->penalty(extra); }
+        void searched(const SearchContext &ctx) { probe->searched(ctx); }
+#endif
+    };
 
-        while (!pq.empty()) {
-            Node current = pq.top();
-            pq.pop();
+    // 快取 key 的規劃模式：waitTime 懲罰、是否允許迴轉、不可回頭的格子、ALT
+    uint32_t plannerMode(bool avoidParking, bool allowUturn, pair<int,int> noGoCell) const {
+        uint32_t mode = (avoidParking ? 1u : 0u) | (allowUturn ? 2u : 0u) | (landmarks ? 4u : 0u);
+        if (!allowUturn && noGoCell.first >= 0) mode |= (uint32_t)(noGoCell.first * cols + noGoCell.second + 1) << 3;
+        return mode;
+    }
 
-            if (current.row == endRow && current.col == endCol) {
-                moveVehicleCallback(current.path, vehicleID);
-                return true;
-            }
+    static uint64_t elapsedNanos(steady_clock::time_point t0) {
+        return (uint64_t)duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+    }
 
-            const int dr[] = {-1, 1, 0, 0};
-            const int dc[] = {0, 0, -1, 1};
+public:
+    ParkingLot() {
+        //                        ENTRANCE, AISLE, WALL, PARKING_SPACE, VEHICLE, CLOSED_AISLE
+        parkingLot.definePassClass({LotGrid::PASS_ALWAYS, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER,
+                                    LotGrid::PASS_NEVER, LotGrid::PASS_IF_MOVING, LotGrid::PASS_NEVER});
+        parkingLot.definePassClass({LotGrid::PASS_ALWAYS, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER,
+                                    LotGrid::PASS_NEVER, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER});
+        parkingLot.definePassClass({LotGrid::PASS_ALWAYS, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER,
+                                    LotGrid::PASS_ALWAYS, LotGrid::PASS_ALWAYS, LotGrid::PASS_NEVER});
+        parkingLot.setStampClasses(1u << PASS_ROUTE); // A* 只讀 PASS_ROUTE
+        resize(MAX_ROWS, MAX_COLS);
+    }
 
-            for (int i = 0; i < 4; ++i) {
-                int newRow = current.row + dr[i];
-                int newCol = current.col + dc[i];
+    // 全部重設為 rows×cols 的通道
+    void resize(int r, int c) {
+        rows = r;
+        cols = c;
+        parkingLot.reset(rows, cols, AISLE, true);
+        closures.reset(rows, cols);
+        closedBaseType.assign((size_t)rows * cols, AISLE);
+        routeIndex.reset(rows, cols);
+        freeStalls.reset(rows, cols);
+        parkedStalls.reset((size_t)rows * cols);
+    }
 
-                if (newRow == noGoCell.first && newCol == noGoCell.second && !allowUturn) {
-                    continue;
-                }
+    // 改變格子的 type，同時維護車位索引
+    void assignType(int r, int c, CellType t) {
+        uint8_t old = parkingLot.type(r, c);
+        parkingLot.setType(r, c, t);
+        if (t == PARKING_SPACE) freeStalls.add(r, c);
+        else if (old == PARKING_SPACE) freeStalls.remove(r, c);
+        if (t != VEHICLE) parkedStalls.erase(parkingLot.index(r, c));
+    }
 
-                if (newRow >=0 && newRow < MAX_ROWS && newCol>=0 && newCol < MAX_COLS) {
-                    CellType t = parkingLot[newRow][newCol].type;
-                    if (t == CLOSED_AISLE || t == WALL || t == PARKING_SPACE) continue;
-                    //if (!isCellValid(newRow, newCol)) continue;
-                    int baseG = current.g + 1;
-                    int extra = 0;
-                    if (parkingLot[newRow][newCol].waitTime > 0 && isupper((unsigned char)vehicleID)) {
-                        extra = std::max(parkingLot[newRow][newCol].waitTime - baseG, 0);
-                    }
-                    int newG = baseG + extra;                    
-                    if (newG < cost[newRow][newCol]) {
-                        cost[newRow][newCol] = newG;
-                        int hVal = heuristic(newRow, newCol, endRow, endCol);
-                        Node newNode{newRow, newCol, newG, hVal};
-                        newNode.path = current.path;
-                        newNode.path.emplace_back(newRow, newCol);
-                        pq.push(newNode);
-                    }
-                }
+    // 以執行期載入的地圖取代內建地圖 (須在 enableLandmarks / enableIncremental 之前)
+    void loadLayout(const LotLayout &layout) {
+        resize(layout.rows, layout.cols);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                LayoutCell t = layout.at(i, j);
+                if (t == LayoutCell::Wall) assignType(i, j, WALL);
+                else if (t == LayoutCell::Stall) assignType(i, j, PARKING_SPACE);
             }
         }
-        cout << "No valid path found.\n";
+        entrances = layout.entrances;
+        exits = layout.exits;
+    }
+
+    // 目前地圖轉成 LotLayout (--save-layout)；出口與入口相同時只標入口
+    LotLayout toLayout() const {
+        LotLayout layout;
+        layout.reset(rows, cols);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                uint8_t t = parkingLot.type(i, j);
+                layout.set(i, j, t == WALL ? LayoutCell::Wall : t == PARKING_SPACE ? LayoutCell::Stall : LayoutCell::Aisle);
+            }
+        }
+        for (auto &e : exits) layout.set(e.first, e.second, LayoutCell::Exit);
+        for (auto &e : entrances) layout.set(e.first, e.second, LayoutCell::Entrance);
+        layout.collectPortals();
+        return layout;
+    }
+
+    int rowCount() const { return rows; }
+    int colCount() const { return cols; }
+
+    static pair<int,int> nearest(const vector<pair<int,int>> &portals, int r, int c) {
+        pair<int,int> best = portals[0];
+        for (auto &p : portals) {
+            if (abs(p.first - r) + abs(p.second - c) < abs(best.first - r) + abs(best.second - c)) best = p;
+        }
+        return best;
+    }
+
+    static bool isPortal(const vector<pair<int,int>> &portals, int r, int c) {
+        for (auto &p : portals) {
+            if (p.first == r && p.second == c) return true;
+        }
         return false;
     }
 
-public:
-    ParkingLot() {
-        for (int i = 0; i < MAX_ROWS; ++i) {
-            for (int j = 0; j < MAX_COLS; ++j) {
-                parkingLot[i][j] = Cell(i, j, AISLE);
+    // 可封閉的格子：通道，或正在通道上行駛的車 (停著車的車位、入口、出口都不行)
+    bool isClosableAisle(int r, int c) const {
+        if (isPortal(entrances, r, c) || isPortal(exits, r, c)) return false;
+        uint8_t t = parkingLot.type(r, c);
+        if (t == AISLE) return true;
+        return t == VEHICLE && !parkedStalls.contains(parkingLot.index(r, c));
+    }
+
+    // 封閉一格 (可同時有任意多格)；回傳剩餘路線經過這格、被通知重規劃的車輛數，不是通道時回傳 -1
+    int closeCell(int r, int c) {
+        if (closures.isClosed(r, c)) return 0;
+        if (!isClosableAisle(r, c)) return -1;
+        uint8_t t = parkingLot.type(r, c);
+        closures.close(r, c);
+        closedBaseType[parkingLot.index(r, c)] = t == VEHICLE ? (uint8_t)AISLE : t; // 車開走後由 stepOnce 處理
+        setCellType(r, c, CLOSED_AISLE);
+        if (trace) trace->event(TraceEvent::Close, (uint32_t)parkingLot.index(r, c));
+        int notified = 0;
+        for (int v : routeIndex.vehiclesOn(r, c)) {
+            // 只有行駛中的車會檢查 rerouteRequested；倒車中的車仍登記在最後一格通道上
+            MoveState *mv = vehicles[(VehicleId)v].move;
+            if (mv && mv->phase == DRIVING && !mv->rerouteRequested) {
+                mv->rerouteRequested = true;
+                notified++;
             }
         }
-        lastDisplayTime.store(0);
+        return notified;
+    }
+
+    bool reopenCell(int r, int c) {
+        if (!closures.reopen(r, c)) return false;
+        setCellType(r, c, (CellType)closedBaseType[parkingLot.index(r, c)]);
+        if (trace) trace->event(TraceEvent::Reopen, (uint32_t)parkingLot.index(r, c));
+        return true;
+    }
+
+    size_t closedCellCount() const {
+        return closures.count();
+    }
+
+    void setClock(SimClock *c) {
+        clock = c;
+    }
+
+    // 仍在行駛 (含倒車) 的車輛數；virtual 模式用來判斷模擬是否結束
+    int activeMoveCount() const {
+        return activeMoves.load();
     }
 
     void setCellType(int r, int c, CellType t) {
         lock_guard<mutex> lk(mtx);
-        parkingLot[r][c].type = t;
+        assignType(r, c, t);
+        if (landmarks) {
+            landmarks->setPassable(r, c, isStaticPassable(r, c)); // 只重算受影響的距離表
+            if (routeCache) routeCache->invalidateAll();          // heuristic 變了，搜尋順序可能不同
+        }
+        if (useIncremental) {
+            uint8_t b = isTopoBlocked(r, c) ? 1 : 0;
+            if (topoBlocked[r * cols + c] != b) {
+                topoBlocked[r * cols + c] = b;
+                vehicles.forEach([r, c](VehicleId, VehicleInfo &info) {
+                    if (info.planner) info.planner->cellChanged(r, c);
+                });
+            }
+        }
+    }
+
+    // 依目前地圖建立 D* Lite 使用的 blocked 平面；之後的封閉由 setCellType 通知各車
+    void enableIncremental() {
+        useIncremental = true;
+        topoBlocked.assign((size_t)rows * cols, 0);
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c) topoBlocked[r * cols + c] = isTopoBlocked(r, c) ? 1 : 0;
+    }
+
+    // 建立重規劃派工執行緒 + worker pool
+    void startReplanDispatcher(unsigned threads) {
+        replanner.reset(new Replanner([this](AffectedVehicleInfo &avi) { planReplan(avi); }, threads));
+    }
+
+    // 處理完剩餘紀錄後結束派工執行緒，並印出延遲統計
+    void stopReplanDispatcher() {
+        if (!replanner) return;
+        replanner->shutdown();
+        cout << "[replan dispatcher] workers=" << replanner->workerCount() << ", replans=" << replanner->handledCount()
+             << ", event-to-route latency mean=" << replanner->meanLatencyUs() << " us, max="
+             << replanner->maxLatencyUs() << " us\n";
+        replanner.reset();
+    }
+
+    void printIncrementalStats() const {
+        if (!useIncremental) return;
+        cout << "[incremental] replans=" << incrementalReplans << ", expansions/replan="
+             << (incrementalReplans ? (double)incrementalReplanExpansions / incrementalReplans : 0.0)
+             << " (initial plans=" << incrementalPlans << ", expansions/plan="
+             << (incrementalPlans ? (double)incrementalInitialExpansions / incrementalPlans : 0.0) << ")\n";
+    }
+
+    void enableRouteCache() {
+        routeCache.reset(new RouteCache());
+    }
+
+    // --route-cache 的命中率與省下的規劃時間 (未命中的平均耗時 - 命中的平均耗時) × 命中次數
+    void printRouteCacheStats() const {
+        if (!routeCache) return;
+        RouteCache::Stats s = routeCache->stats();
+        double hitUs = s.hits ? s.hitNanos / 1000.0 / s.hits : 0.0;
+        double missUs = s.misses() ? s.missNanos / 1000.0 / s.misses() : 0.0;
+        cout << "[route cache] lookups=" << s.lookups << ", hits=" << s.hits << " ("
+             << (s.lookups ? 100.0 * s.hits / s.lookups : 0.0) << "%), stale=" << s.stale << ", avg hit=" << hitUs
+             << " us, avg miss=" << missUs << " us, saved~" << s.hits * std::max(missUs - hitUs, 0.0) / 1000.0
+             << " ms\n";
+    }
+
+    // 依目前地圖建立 ALT 距離表：入口/出口 + 四個角落
+    size_t enableLandmarks() {
+        auto passable = [this](int r, int c) { return isStaticPassable(r, c); };
+        vector<pair<int,int>> fixed = entrances;
+        for (auto &e : exits) {
+            if (find(fixed.begin(), fixed.end(), e) == fixed.end()) fixed.push_back(e);
+        }
+        landmarks.reset(new LandmarkHeuristic());
+        landmarks->build(rows, cols, LandmarkHeuristic::pickLandmarks(rows, cols, passable, fixed), passable);
+        return landmarks->landmarkCount();
+    }
+
+    uint64_t landmarkRebuilds() const {
+        return landmarks ? landmarks->fieldRebuilds() : 0;
     }
 
     void addCell(int row, int col, CellType type) {
-        parkingLot[row][col].type = type;
+        assignType(row, col, type);
     }
 
-    const Cell (*getParkingLot() const)[MAX_COLS] {
+    const LotGrid& getParkingLot() const {
         return parkingLot;
     }
 
@@ -263,11 +661,34 @@ public:
         return vehicleTimes;
     }
 
-    bool addVehicle(int row, int col, char vehicleID) {
-        if (parkingLot[row][col].type == PARKING_SPACE) {
-            parkingLot[row][col].type = VEHICLE;
-            parkingLot[row][col].vehicleID = vehicleID;
-            parkingLot[row][col].isMoving = false;
+    // 登記一台新車，回傳它的 ID (label 為 0 時以 V<id> 顯示)
+    VehicleId registerVehicle(char label) {
+        VehicleInfo info;
+        info.label = label;
+        return vehicles.add(std::move(info));
+    }
+
+    void reserveVehicles(size_t n) {
+        vehicles.reserve(n);
+    }
+
+    string vehicleName(VehicleId id) const {
+        return ::vehicleName(id, vehicles[id].label);
+    }
+
+    // 地圖上顯示的字元：有字母 ID 沿用，否則依 ID 循環使用 A~Z (離場為小寫)
+    char vehicleGlyph(VehicleId id) const {
+        const VehicleInfo &info = vehicles[id];
+        if (info.label == '\0') return ::vehicleGlyph(id, info.role);
+        return info.role == VehicleRole::Departing ? (char)tolower((unsigned char)info.label) : info.label;
+    }
+
+    bool addVehicle(int row, int col, VehicleId vehicleID) {
+        if (parkingLot.type(row, col) == PARKING_SPACE) {
+            assignType(row, col, VEHICLE);
+            parkedStalls.insert(parkingLot.index(row, col));
+            parkingLot.setOccupant(row, col, vehicleID);
+            parkingLot.setMoving(row, col, false);
 
             // 將該車輛的目標位置記錄下來 (row,col)為此車的最終停車位置
             
@@ -276,9 +697,12 @@ public:
             for (auto &dir : directions) {
                 int newRow = row + dir[0], newCol = col + dir[1];
                 if (isCellValid(newRow, newCol)) {
-                    vehicleDestinations[vehicleID] = {newRow, newCol};
-                    auto mvCallback = [&](vector<pair<int,int>>& p, char vID){ moveVehicleImpl(p,vID); };
-                    bool res = aStarWithReturn(0, 8, newRow, newCol, vehicleID, {-1,-1}, true, mvCallback);
+                    vehicles[vehicleID].hasDestination = true;
+                    vehicles[vehicleID].destination = {newRow, newCol};
+                    auto mvCallback = [&](vector<pair<int,int>>& p, VehicleId vID){ moveVehicleImpl(p,vID); };
+                    pair<int,int> in = nearest(entrances, newRow, newCol);
+                    bool res = aStarWithReturn(in.first, in.second, newRow, newCol, vehicleID, {-1,-1}, true, mvCallback);
+                    if (res) trackIncremental(vehicleID, in, {newRow, newCol});
                     return res;
                 }
             }
@@ -290,19 +714,24 @@ public:
         }
     }
 
-    bool removeVehicle(int row, int col, char vehicleID) {
-        if (parkingLot[row][col].type == VEHICLE) {
-            parkingLot[row][col].type = PARKING_SPACE;
+    bool removeVehicle(int row, int col, VehicleId vehicleID) {
+        if (parkingLot.type(row, col) == VEHICLE) {
+            assignType(row, col, PARKING_SPACE);
 
-            // 離開停車場的目標是(0,8)
-            vehicleDestinations[vehicleID] = {0, 8};
+            // 離開停車場的目標是最近的出口
+            pair<int,int> out = nearest(exits, row, col);
+            VehicleInfo &info = vehicles[vehicleID];
+            info.role = VehicleRole::Departing;
+            info.hasDestination = true;
+            info.destination = out;
 
             int directions[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
             for (auto &dir : directions) {
                 int newRow = row + dir[0], newCol = col + dir[1];
                 if (isCellValid(newRow, newCol)) {
-                    auto mvCallback = [&](vector<pair<int,int>>& p, char vID){ moveVehicleImpl(p,vID); };
-                    bool res = aStarWithReturn(newRow, newCol, 0, 8, vehicleID, {-1,-1}, true, mvCallback);
+                    auto mvCallback = [&](vector<pair<int,int>>& p, VehicleId vID){ moveVehicleImpl(p,vID); };
+                    bool res = aStarWithReturn(newRow, newCol, out.first, out.second, vehicleID, {-1,-1}, true, mvCallback);
+                    if (res) trackIncremental(vehicleID, {newRow, newCol}, out);
                     return res;
                 }
             }
@@ -314,167 +743,224 @@ public:
     }
 
 
+    // 亂數由 main 的 seed 決定 (不再以 time 重設，同一個 seed 結果固定)
+    //   由空車位索引直接挑 (O(1))；--nearest-stall K 時只在離第一個入口最近的 K 個空車位中挑
     pair<int, int> getRandomParkingSpace() {
-        srand((unsigned)time(nullptr));
-        vector<pair<int, int>> availableSpaces;
-
-        for (int i = 0; i < MAX_ROWS; ++i) {
-            for (int j = 0; j < MAX_COLS; ++j) {
-                if (parkingLot[i][j].type == PARKING_SPACE) {
-                    availableSpaces.emplace_back(i, j);
-                }
-            }
+        if (freeStalls.empty()) return make_pair(-1, -1);
+        if (nearestStallChoices > 0) {
+            vector<pair<int, int>> near = freeStalls.nearest(entrances.front().first, entrances.front().second,
+                                                             (size_t)nearestStallChoices);
+            return near[rand() % near.size()];
         }
+        return freeStalls.at(rand() % freeStalls.size());
+    }
 
-        return !availableSpaces.empty() ? availableSpaces[rand() % availableSpaces.size()] : make_pair(-1, -1);
+    // 隨機挑一個停著車的車位 (O(1))；沒有時回傳 (-1, -1)
+    pair<int, int> getRandomParkedVehicle() {
+        if (parkedStalls.empty()) return make_pair(-1, -1);
+        int idx = parkedStalls.at(rand() % parkedStalls.size());
+        return make_pair(idx / cols, idx % cols);
     }
 
-    void displayStatus() {
-        static std::atomic_flag isDisplaying = ATOMIC_FLAG_INIT;
-
-        if (isDisplaying.test_and_set()) {
-            return;
-        }
-
-        try {
-            auto now = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
-            long long timeSinceLastDisplay = now - lastDisplayTime.load();
-
-            if (timeSinceLastDisplay >= 1000) {
-                lastDisplayTime.store(now);
-
-                system("cls");
-
-                cout << "  ";
-                for (int i = 0; i < MAX_COLS; ++i) cout << i % 10 << " ";
-                cout << "\n";
-                for (int i = 0; i < MAX_ROWS; ++i) {
-                    cout << i % 10 << " ";
-                    for (int j = 0; j < MAX_COLS; ++j) {
-                        char displayChar;
-
-                        if (parkingLot[i][j].waitTime > 0) {
-                            displayChar = '0' + (parkingLot[i][j].waitTime % 10);
-                        } else {
-                            switch (parkingLot[i][j].type) {
-                                case ENTRANCE: displayChar = ' '; break;
-                                case AISLE: displayChar = ' '; break;
-                                case WALL: displayChar = '+'; break;
-                                case PARKING_SPACE: displayChar = '-'; break;
-                                case VEHICLE: displayChar = parkingLot[i][j].vehicleID; break;
-                                case CLOSED_AISLE: displayChar = '#'; break;
-                            }
-                        }
-
-                        cout << displayChar << " ";
-                    }
-
-                    cout << "\n";
-                }
-                cout << "\n";
-            }
-        } catch (...) {
-            isDisplaying.clear();
-            throw;
-        }
+    void setNearestStallChoices(int k) {
+        nearestStallChoices = k;
+    }
 
-        isDisplaying.clear();
+    void setArrivalWave(int n) {
+        arrivalWave = n;
     }
 
-    bool isVehicleAffectedByClosedCell(const vector<pair<int,int>>& path) {
-        for (auto &p : path) {
-            if (p.first == closedCellRow && p.second == closedCellCol) {
-                return true;
+    bool usingArrivalWaves() const { return arrivalWave > 0; }
+
+    // --assign-wave：依序取這一波指派好的車位；用完時為接下來的 (最多 upcoming 台) 車重新指派
+    //   指派後車位被別的事件佔走時跳過，整波都不能用時退回隨機挑選
+    pair<int, int> getAssignedParkingSpace(int upcoming) {
+        if (waveStalls.empty()) planArrivalWave(min(arrivalWave, upcoming));
+        while (!waveStalls.empty()) {
+            pair<int, int> s = waveStalls.front();
+            waveStalls.pop_front();
+            if (freeStalls.isFree(s.first, s.second)) return s;
+        }
+        return getRandomParkingSpace();
+    }
+
+    // 每個入口一次 Dijkstra (含目前的 waitTime 懲罰) 得到到所有空車位的成本，再做最小成本指派
+    //   車位旁的通道格與 addVehicle 相同 (上、下、左、右第一個可通行格)，入口與 addVehicle 一樣選最近的
+    void planArrivalWave(int n) {
+        vector<DistanceField> fields(entrances.size());
+        for (size_t e = 0; e < entrances.size(); ++e)
+            fields[e].build(parkingLot, PASS_ROUTE, entrances[e].first, entrances[e].second, true);
+
+        vector<StallCandidate> cands;
+        cands.reserve(freeStalls.size());
+        const int directions[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        for (size_t i = 0; i < freeStalls.size(); ++i) {
+            pair<int, int> s = freeStalls.at(i);
+            for (auto &dir : directions) {
+                int ar = s.first + dir[0], ac = s.second + dir[1];
+                if (!isCellValid(ar, ac)) continue;
+                pair<int, int> in = nearest(entrances, ar, ac);
+                int field = (int)(find(entrances.begin(), entrances.end(), in) - entrances.begin());
+                cands.push_back(StallCandidate{s.first, s.second, ar, ac, field});
+                break;
             }
         }
-        return false;
+        // 還在路上 (含等待重規劃) 的進場車的終點：這一波的車位不要緊鄰它們
+        vector<pair<int, int>> busy;
+        vehicles.forEach([&](VehicleId, const VehicleInfo &info) {
+            if (info.role == VehicleRole::Arriving && info.hasDestination && info.moveTime < 0)
+                busy.push_back(info.destination);
+        });
+        WaveOptions opt;
+        opt.parkTicks = PARK_TICKS;
+        for (int k : assignWave(cands, fields, n, busy, opt)) {
+            if (k >= 0) waveStalls.emplace_back(cands[k].row, cands[k].col);
+        }
+        cout << "Arrival wave: " << waveStalls.size() << " stall(s) assigned to the next " << n << " vehicle(s).\n";
     }
 
-    bool replanForVehicleWithReturn(AffectedVehicleInfo &avi) {
-        int startRow = avi.remainingPath[0].first;
-        int startCol = avi.remainingPath[0].second;
-        int endRow = avi.endRow;
-        int endCol = avi.endCol;
-        char vID = avi.vehicleID;
-        pair<int,int> noGoCell = avi.currentPos;
+    void setRenderer(LotRenderer *r) {
+        renderer = r;
+    }
 
+    // --trace：從目前的地圖開始記錄 (type 的顯示字元依 CellType 順序)
+    bool startTrace(TraceWriter &w, const string &path) {
+        if (!w.open(path, parkingLot, "  +-*#")) return false;
+        trace = &w;
+        return true;
+    }
+
+    void stopTrace() {
+        trace = nullptr;
+    }
+
+    // 每個 tick 結束時呼叫 (SimClock 的 tick observer)
+    void endTick(SimClock::Tick tick) {
+        if (trace) trace->endTick(tick);
+        displayStatus();
+    }
+
+    // 把目前地圖交給 renderer (由 SimClock 在每個 tick 結束時呼叫，地圖狀態一致)；
+    //   只複製字元快照，輸出在 renderer 自己的執行緒上；headless 時直接返回
+    void displayStatus() {
+        if (!renderer || !renderer->active()) return;
+        string caption = "t=" + to_string(clock ? clock->now() : 0);
+        renderer->publish(rows, cols, caption, [this](int i, int j) {
+            if (parkingLot.waitTime(i, j) > 0) return (char)('0' + (parkingLot.waitTime(i, j) % 10));
+            switch (parkingLot.type(i, j)) {
+                case WALL: return '+';
+                case PARKING_SPACE: return '-';
+                case VEHICLE: return vehicleGlyph(parkingLot.occupant(i, j));
+                case CLOSED_AISLE: return '#';
+                default: return ' '; // ENTRANCE、AISLE
+            }
+        });
+    }
+
+    // 送出重規劃 (模擬時鐘執行緒)：終點修正與 D* Lite 建立在這裡做，
+    // 並在本 tick 排一次 flush，不必等下一次輪詢
+    void submitReplan(AffectedVehicleInfo avi) {
         // 如果 endRow,endCol是停車位或不可通行的格，重新找出相鄰AISLE作為新終點
-        if (parkingLot[endRow][endCol].type == PARKING_SPACE) {
+        if (parkingLot.type(avi.endRow, avi.endCol) == PARKING_SPACE) {
             bool foundAisle = false;
             int directions[4][2] = {{-1,0},{1,0},{0,-1},{0,1}};
             for (auto &dir : directions) {
-                int newRow = endRow + dir[0];
-                int newCol = endCol + dir[1];
+                int newRow = avi.endRow + dir[0];
+                int newCol = avi.endCol + dir[1];
                 if (isCellValid(newRow, newCol)) {
-                    endRow = newRow;
-                    endCol = newCol;
+                    avi.endRow = newRow;
+                    avi.endCol = newCol;
                     foundAisle = true;
                     break;
                 }
             }
             if (!foundAisle) {
                 cout << "No valid aisle adjacent to the parking space end target.\n";
-                return false;
+                avi.goalOk = false;
             }
         }
+        if (useIncremental && avi.goalOk) {
+            const unique_ptr<DStarLite> &planner = vehicles[avi.vehicleID].planner;
+            if (!planner || planner->goalRow() != avi.endRow || planner->goalCol() != avi.endCol) {
+                trackIncremental(avi.vehicleID, avi.remainingPath[0], {avi.endRow, avi.endCol});
+            }
+        }
+        replanner->submit(std::move(avi));
+        if (!replanFlushScheduled) {
+            replanFlushScheduled = true;
+            clock->schedule(clock->now(), [this]() { flushReplans(); });
+        }
+    }
 
-        auto mvCallback = [&](vector<pair<int,int>>& p, char vID){ moveVehicleImpl(p,vID); };
+    // 在 replan worker 上執行：只讀地圖 (flush 期間模擬時鐘停住)，結果寫回紀錄
+    void planReplan(AffectedVehicleInfo &avi) {
+        if (!avi.goalOk) return;
+        // 增量式：只修補這台車既有的搜尋狀態 (目前位置本身就是 noGoCell，不需另外排除)
+        if (useIncremental && replanIncremental(avi)) return;
+
+        int startRow = avi.remainingPath[0].first;
+        int startCol = avi.remainingPath[0].second;
+        pair<int,int> noGoCell = avi.currentPos;
+        auto keepPath = [&avi](vector<pair<int,int>>& p, VehicleId) {
+            avi.newPath = p;
+            avi.found = true;
+        };
 
         // 第一次嘗試，不允許迴轉
-        bool success = aStarWithReturn(startRow, startCol, endRow, endCol, vID, noGoCell, false, mvCallback);
+        bool success = aStarWithReturn(startRow, startCol, avi.endRow, avi.endCol, avi.vehicleID, noGoCell, false, keepPath);
         if (!success) {
             // 第二次嘗試，允許迴轉
-            success = aStarWithReturn(startRow, startCol, endRow, endCol, vID, noGoCell, true, mvCallback);
+            aStarWithReturn(startRow, startCol, avi.endRow, avi.endCol, avi.vehicleID, noGoCell, true, keepPath);
         }
-        return success;
     }
 
-
-
-    // 重新規劃的邏輯由外部replanVehicles函式呼叫本函式
-};
-
-// 靜態成員初始化
-atomic<bool> ParkingLot::eventTriggered(false);
-int ParkingLot::closedCellRow = -1;
-int ParkingLot::closedCellCol = -1;
-mutex ParkingLot::replanMtx;
-vector<ParkingLot::AffectedVehicleInfo> ParkingLot::affectedVehicles;
-condition_variable ParkingLot::replanCV;
-
-void removeRandomVehicle(ParkingLot& parkingLot) {
-    srand((unsigned)time(nullptr));
-    vector<pair<int, int>> vehiclePositions;
-
-    // 使用getParkingLot()存取
-    auto lot = parkingLot.getParkingLot();
-    for (int i = 0; i < ParkingLot::MAX_ROWS; ++i) {
-        for (int j = 0; j < ParkingLot::MAX_COLS; ++j) {
-            if (lot[i][j].type == VEHICLE && isalpha(lot[i][j].vehicleID)) {
-                vehiclePositions.emplace_back(i, j);
+    // 本 tick 的最後：叫醒派工者、等平行規劃完成，再依 remainingLen 順序讓車輛上路
+    void flushReplans() {
+        replanFlushScheduled = false;
+        for (auto &avi : replanner->flush()) {
+            cout << "Replanning for vehicle " << vehicleName(avi.vehicleID) << "...\n";
+            vehicles[avi.vehicleID].replans++;
+            if (trace) trace->event(TraceEvent::Replan, avi.vehicleID, avi.found ? (uint32_t)avi.newPath.size() : 0);
+            if (avi.found) {
+                moveVehicleImpl(avi.newPath, avi.vehicleID);
+            } else {
+                cout << "Vehicle " << vehicleName(avi.vehicleID) << " could not find a path even after allowing U-turn.\n";
             }
         }
     }
+};
 
-    if (!vehiclePositions.empty()) {
-        auto vehiclePos = vehiclePositions[rand() % vehiclePositions.size()];
-        char vehicleID = lot[vehiclePos.first][vehiclePos.second].vehicleID;
-        cout << "Vehicle " << vehicleID << " is leaving the parking lot.\n";
+void removeRandomVehicle(ParkingLot& parkingLot) {
+    // 只從停在車位上的車挑 (車位索引)，不再掃整張地圖
+    pair<int, int> vehiclePos = parkingLot.getRandomParkedVehicle();
+    const auto &lot = parkingLot.getParkingLot();
+    if (vehiclePos.first != -1 && lot.occupant(vehiclePos.first, vehiclePos.second) != NO_VEHICLE) {
+        VehicleId vehicleID = lot.occupant(vehiclePos.first, vehiclePos.second);
+        cout << "Vehicle " << parkingLot.vehicleName(vehicleID) << " is leaving the parking lot.\n";
         parkingLot.removeVehicle(vehiclePos.first, vehiclePos.second, vehicleID);
     }
 }
 
-void addVehicleWithRandomSpace(ParkingLot& parkingLot, char vehicleID) {
+void addVehicleWithRandomSpace(ParkingLot& parkingLot, VehicleId vehicleID) {
     pair<int, int> parkingSpace = parkingLot.getRandomParkingSpace();
     if (parkingSpace.first != -1) {
-        cout << "Vehicle " << vehicleID << " is entering the parking lot.\n";
+        cout << "Vehicle " << parkingLot.vehicleName(vehicleID) << " is entering the parking lot.\n";
         parkingLot.addVehicle(parkingSpace.first, parkingSpace.second, vehicleID);
     }
 }
 
-void addRandomVehicle(ParkingLot& parkingLot, char vehicleID) {
+void addRandomVehicle(ParkingLot& parkingLot, VehicleId vehicleID) {
     addVehicleWithRandomSpace(parkingLot, vehicleID);
 }
+
+// --assign-wave：車位由這一波的指派決定 (upcoming = 含這台在內還要進場的車數)
+void addVehicleWithAssignedSpace(ParkingLot& parkingLot, VehicleId vehicleID, int upcoming) {
+    pair<int, int> parkingSpace = parkingLot.getAssignedParkingSpace(upcoming);
+    if (parkingSpace.first != -1) {
+        cout << "Vehicle " << parkingLot.vehicleName(vehicleID) << " is entering the parking lot.\n";
+        parkingLot.addVehicle(parkingSpace.first, parkingSpace.second, vehicleID);
+    }
+}
 /*
 void triggerEvent(ParkingLot &parkingLot) {
     this_thread::sleep_for(chrono::seconds(20));
@@ -505,48 +991,127 @@ void triggerEvent(ParkingLot &parkingLot) {
     }
 }
 */
+void closeCell(ParkingLot &parkingLot, int chosenRow, int chosenCol) {
+    int notified = parkingLot.closeCell(chosenRow, chosenCol);
+    if (notified < 0) {
+        cout << "Cell (" << chosenRow << "," << chosenCol << ") is not an aisle; closure ignored.\n";
+        return;
+    }
+    cout << "Event triggered! Cell (" << chosenRow << "," << chosenCol << ") is now CLOSED_AISLE.\n";
+    if (notified > 0) {
+        cout << notified << " vehicle(s) routed through it will replan.\n";
+    }
+}
+
+void reopenCell(ParkingLot &parkingLot, int row, int col) {
+    if (parkingLot.reopenCell(row, col)) {
+        cout << "Cell (" << row << "," << col << ") reopened.\n";
+    }
+}
+
+// 原本的 triggerEvent：t=5 時手動封閉 (1,10) (載入的地圖太小時略過)
 void triggerEvent(ParkingLot &parkingLot) {
-    this_thread::sleep_for(chrono::seconds(5));
     int chosenRow = 1; // 手動指定列
     int chosenCol = 10; // 手動指定行
-
-    parkingLot.setCellType(chosenRow, chosenCol, CLOSED_AISLE);
-
-    ParkingLot::closedCellRow = chosenRow;
-    ParkingLot::closedCellCol = chosenCol;
-
-    ParkingLot::eventTriggered.store(true);
-    cout << "Event triggered! Cell (" << chosenRow << "," << chosenCol << ") is now CLOSED_AISLE.\n";
+    if (chosenRow >= parkingLot.rowCount() || chosenCol >= parkingLot.colCount()) return;
+    closeCell(parkingLot, chosenRow, chosenCol);
 }
 
+// 命令列指定的額外封閉 / 重新開放：R,C@T
+struct CellEvent {
+    int row, col;
+    long long tick;
+    bool reopen = false;
+};
 
-void replanVehicles(ParkingLot &parkingLot) {
-    while (true) {
-        this_thread::sleep_for(chrono::seconds(1));
-        if (ParkingLot::eventTriggered.load()) {
-            lock_guard<mutex> lk(ParkingLot::replanMtx);
-            if (!ParkingLot::affectedVehicles.empty()) {
-                sort(ParkingLot::affectedVehicles.begin(), ParkingLot::affectedVehicles.end(), 
-                     [](const ParkingLot::AffectedVehicleInfo &a, const ParkingLot::AffectedVehicleInfo &b){
-                         return a.remainingLen < b.remainingLen;
-                     });
-                while (!ParkingLot::affectedVehicles.empty()) {
-                    auto avi = ParkingLot::affectedVehicles.front();
-                    ParkingLot::affectedVehicles.erase(ParkingLot::affectedVehicles.begin());
-                    cout << "Replanning for vehicle " << avi.vehicleID << "...\n";
-                    bool success = parkingLot.replanForVehicleWithReturn(avi);
-                    if (!success) {
-                        cout << "Vehicle " << avi.vehicleID << " could not find a path even after allowing U-turn.\n";
-                    }
+bool parseCellEvent(const string &s, CellEvent &ev) {
+    int r, c;
+    long long t;
+    char comma, at;
+    if (sscanf(s.c_str(), "%d%c%d%c%lld", &r, &comma, &c, &at, &t) != 5 || comma != ',' || at != '@') return false;
+    if (r < 0 || c < 0 || t < 0) return false; // 上界在地圖決定後才檢查
+    ev.row = r;
+    ev.col = c;
+    ev.tick = t;
+    return true;
+}
 
-                }
+// 車輛互卡 (gridlock) 時不會自然結束，模擬最多跑這麼多 tick (--max-ticks 可調整)
+static const long long MAX_SIM_TICKS = 3600;
+
+// 參數：[--seed N] [--realtime] [--alt] [--incremental] [--replan-threads N]
+//       [--close R,C@T]... [--reopen R,C@T]... [--layout FILE] [--save-layout FILE]
+//       [--vehicles N] [--max-ticks N] [--route-cache] [--search-stats FILE] [--nearest-stall K]
+//       [--assign-wave N] [--render ansi|plain|headless] [--fps N] [--trace FILE]
+//   預設為 virtual 時鐘 (不 sleep，毫秒內跑完)；--realtime 以真實秒數逐秒展示，結果相同
+//   --alt：A* 改用 ALT landmark heuristic，CLOSED_AISLE 出現時修補距離表
+//   --incremental：封閉通道後的重規劃改用每台車的 D* Lite，只修補變動的部分
+//   --replan-threads：重規劃 worker 數 (預設為核心數)
+//   --close / --reopen：在 t=5 的 (1,10) 之外，於 tick T 封閉 / 重新開放 (R,C)，可重複指定
+//   --layout：從檔案載入地圖 (.lot 文字或 .lotb 二進位) 取代內建的 17×24；--save-layout 寫出目前地圖
+//   --route-cache：A* 結果依 (起點, 終點, 模式) 快取，讀過的區塊改變即失效；結束時印出命中率
+//   --vehicles：進場車輛數 (預設 15~20 台)；超過 26 台時不再使用字母 ID，改以 V<id> 顯示
+//   --search-stats：每次 A* 的計數寫成 CSV (.json => JSON)，run 欄位 = seed；需以 -DSEARCH_STATS=ON 編譯
+//   --nearest-stall：進場車從離入口最近的 K 個空車位中隨機挑 (預設從全部空車位中挑)
+//   --assign-wave：每 N 台進場車為一波，以入口出發的距離場 + 最小成本指派決定車位 (取代隨機挑選)
+//   --render：地圖畫面 (ansi = 只重畫變動的格子、plain = 整張文字、headless = 不輸出)，
+//             在自己的執行緒上以 --fps (預設 10) 更新；預設 --realtime 時 ansi，否則 headless
+//   --trace：逐 tick 的車輛位置、格子變化、封閉 / 重規劃事件寫成二進位軌跡 (trace_replay 檢視)
+int main(int argc, char *argv[]) {
+    bool realtime = false;
+    bool alt = false;
+    bool incremental = false;
+    unsigned replanThreads = 0;
+    vector<CellEvent> cellEvents;
+    string layoutPath, saveLayoutPath;
+    unsigned seed = (unsigned)time(nullptr);
+    int vehicleOverride = 0;
+    bool routeCache = false;
+    long long maxTicks = MAX_SIM_TICKS;
+    string searchStatsPath;
+    int nearestStall = 0;
+    int assignWaveSize = 0;
+    string renderArg;
+    int fps = 10;
+    string tracePath;
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        if (arg == "--realtime") realtime = true;
+        else if (arg == "--alt") alt = true;
+        else if (arg == "--incremental") incremental = true;
+        else if (arg == "--replan-threads" && a + 1 < argc) replanThreads = (unsigned)stoul(argv[++a]);
+        else if ((arg == "--close" || arg == "--reopen") && a + 1 < argc) {
+            CellEvent ev;
+            if (!parseCellEvent(argv[++a], ev)) {
+                cout << "Bad " << arg << " value (expected R,C@T): " << argv[a] << "\n";
+                return 1;
             }
+            ev.reopen = (arg == "--reopen");
+            cellEvents.push_back(ev);
         }
+        else if (arg == "--seed" && a + 1 < argc) seed = (unsigned)stoul(argv[++a]);
+        else if (arg == "--layout" && a + 1 < argc) layoutPath = argv[++a];
+        else if (arg == "--save-layout" && a + 1 < argc) saveLayoutPath = argv[++a];
+        else if (arg == "--vehicles" && a + 1 < argc) vehicleOverride = atoi(argv[++a]);
+        else if (arg == "--max-ticks" && a + 1 < argc) maxTicks = atoll(argv[++a]);
+        else if (arg == "--route-cache") routeCache = true;
+        else if (arg == "--search-stats" && a + 1 < argc) searchStatsPath = argv[++a];
+        else if (arg == "--nearest-stall" && a + 1 < argc) nearestStall = atoi(argv[++a]);
+        else if (arg == "--assign-wave" && a + 1 < argc) assignWaveSize = atoi(argv[++a]);
+        else if (arg == "--render" && a + 1 < argc) renderArg = argv[++a];
+        else if (arg == "--fps" && a + 1 < argc) fps = atoi(argv[++a]);
+        else if (arg == "--trace" && a + 1 < argc) tracePath = argv[++a];
     }
-}
+    LotRenderer::Mode renderMode = realtime ? LotRenderer::Mode::Ansi : LotRenderer::Mode::Headless;
+    if (!renderArg.empty() && !LotRenderer::parseMode(renderArg, renderMode)) {
+        cout << "Bad --render value (expected ansi, plain or headless): " << renderArg << "\n";
+        return 1;
+    }
+    SEARCH_STAT(SearchStats::setDefaultRun(to_string(seed)));
 
-int main() {
+    SimClock clock(realtime);
     ParkingLot parkingLot;
+    parkingLot.setClock(&clock);
 
     parkingLot.addCell(0, 0, WALL);
     parkingLot.addCell(0, 23, WALL);
@@ -586,43 +1151,147 @@ int main() {
         }
     }
 
+    // --layout：以檔案取代上面的內建地圖
+    if (!layoutPath.empty()) {
+        LotLayout layout;
+        string err;
+        auto t0 = steady_clock::now();
+        if (!loadLotLayout(layoutPath, layout, err)) {
+            cout << "Failed to load layout: " << err << "\n";
+            return 1;
+        }
+        parkingLot.loadLayout(layout);
+        double ms = duration<double, milli>(steady_clock::now() - t0).count();
+        cout << "Layout " << layoutPath << ": " << layout.rows << "x" << layout.cols << ", " << layout.stallCount()
+             << " stalls, " << layout.entrances.size() << " entrance(s), " << layout.exits.size()
+             << " exit(s), loaded in " << ms << " ms\n";
+    }
+    if (!saveLayoutPath.empty()) {
+        if (!saveLotLayout(saveLayoutPath, parkingLot.toLayout())) {
+            cout << "Failed to write layout " << saveLayoutPath << "\n";
+            return 1;
+        }
+        cout << "Layout saved to " << saveLayoutPath << "\n";
+    }
+    for (const CellEvent &ev : cellEvents) {
+        if (ev.row >= parkingLot.rowCount() || ev.col >= parkingLot.colCount()) {
+            cout << "Cell (" << ev.row << "," << ev.col << ") is outside the " << parkingLot.rowCount() << "x"
+                 << parkingLot.colCount() << " lot\n";
+            return 1;
+        }
+    }
+
+    if (alt) {
+        size_t n = parkingLot.enableLandmarks();
+        cout << "ALT heuristic: " << n << " landmarks\n";
+    }
+
+    if (incremental) parkingLot.enableIncremental();
+    if (routeCache) parkingLot.enableRouteCache();
+    if (nearestStall > 0) parkingLot.setNearestStallChoices(nearestStall);
+    if (assignWaveSize > 0) parkingLot.setArrivalWave(assignWaveSize);
+    parkingLot.startReplanDispatcher(replanThreads ? replanThreads : thread::hardware_concurrency());
+
+    // 地圖畫面：每個 tick 結束時交出一份快照，輸出在 renderer 的執行緒上
+    LotRenderer renderer(renderMode, fps);
+    parkingLot.setRenderer(&renderer);
     parkingLot.displayStatus();
+    // 軌跡：從這裡的地圖 (車輛進場前) 開始記錄
+    TraceWriter traceWriter;
+    if (!tracePath.empty() && !parkingLot.startTrace(traceWriter, tracePath)) {
+        cout << "Cannot write " << tracePath << "\n";
+        return 1;
+    }
+    if (renderer.active() || traceWriter.isOpen())
+        clock.setTickObserver([&parkingLot](SimClock::Tick t) { parkingLot.endTick(t); });
 
-    srand((unsigned)time(nullptr));
+    srand(seed);
+    cout << "Seed: " << seed << (realtime ? " (realtime)" : " (virtual clock)") << "\n";
     unordered_set<char> usedIDs;
-    vector<thread> threads;
 
     int vehicleCount = rand() % 6 + 15;
+    if (vehicleOverride > 0) vehicleCount = vehicleOverride;
+    bool letterIDs = vehicleCount <= 26; // 原本的字母 ID 只夠 26 台
+    parkingLot.reserveVehicles(vehicleCount);
+
+    // 原本的時間軸改用事件排程：t=5 封閉通道、每 2~3 tick 進一台車
+    // 受影響車輛的重規劃由 ReplanDispatcher 在偵測到的同一 tick 完成 (不再每秒輪詢)
+    int arrived = 0;
+    clock.schedule(5, [&parkingLot]() { triggerEvent(parkingLot); });
+    for (const CellEvent &ev : cellEvents) {
+        clock.schedule(ev.tick, [&parkingLot, ev]() {
+            if (ev.reopen) reopenCell(parkingLot, ev.row, ev.col);
+            else closeCell(parkingLot, ev.row, ev.col);
+        });
+    }
 
-    thread eventThread(triggerEvent, ref(parkingLot));
-    thread replanThread(replanVehicles, ref(parkingLot));
-
-    for (int i = 0; i < vehicleCount; ++i) {
-        char vehicleID;
-        do {
-            vehicleID = 'A' + (char)(rand() % 26);
-        } while (usedIDs.find(vehicleID) != usedIDs.end());
-        usedIDs.insert(vehicleID);
+    function<void()> arrive = [&]() {
+        char label = '\0';
+        if (letterIDs) {
+            do {
+                label = 'A' + (char)(rand() % 26);
+            } while (usedIDs.find(label) != usedIDs.end());
+            usedIDs.insert(label);
+        }
+        VehicleId vehicleID = parkingLot.registerVehicle(label);
         int action = 0; 
         if (action < 1) {
-            threads.emplace_back(addRandomVehicle, ref(parkingLot), vehicleID);
+            if (parkingLot.usingArrivalWaves()) addVehicleWithAssignedSpace(parkingLot, vehicleID, vehicleCount - arrived);
+            else addRandomVehicle(parkingLot, vehicleID);
         } else {
-            threads.emplace_back(removeRandomVehicle, ref(parkingLot));
+            removeRandomVehicle(parkingLot);
+        }
+        if (++arrived < vehicleCount) {
+            int interval = rand() % 2 + 2;
+            clock.scheduleAfter(interval, arrive);
+        }
+    };
+    clock.schedule(0, arrive);
+    auto simStart = steady_clock::now();
+    clock.run(maxTicks);
+    double simMs = duration<double, milli>(steady_clock::now() - simStart).count();
+    renderer.stop(); // 畫完最後一個畫面，之後的統計照一般輸出
+    if (traceWriter.isOpen()) {
+        parkingLot.stopTrace();
+        uint64_t ticks = traceWriter.ticksRecorded();
+        size_t keyframes = traceWriter.keyframeCount();
+        double recordMs = traceWriter.recordMillis();
+        if (!traceWriter.close()) {
+            cout << "Cannot write " << tracePath << "\n";
+        } else {
+            cout << "[trace] " << tracePath << ": " << ticks << " ticks, " << keyframes << " keyframes, "
+                 << traceWriter.bytesWritten() << " bytes (" << (ticks ? (double)traceWriter.bytesWritten() / ticks : 0.0)
+                 << " bytes/tick), recording " << recordMs << " ms of " << simMs << " ms simulation\n";
         }
-        int interval = rand() % 2 + 2;
-        this_thread::sleep_for(chrono::seconds(interval));
     }
-
-    for (auto& th : threads) {
-        th.join();
+    if (parkingLot.activeMoveCount() > 0) {
+        cout << "Simulation stopped at tick " << clock.now() << ": " << parkingLot.activeMoveCount()
+             << " vehicle(s) still blocked (gridlock).\n";
     }
 
     vector<VehicleTime> times = parkingLot.getVehicleTimes();
     for (const auto& vt : times) {
-        cout << "Vehicle " << vt.vehicleID << " move time: " << vt.time << " seconds" << endl;
+        cout << "Vehicle " << parkingLot.vehicleName(vt.vehicleID) << " move time: " << vt.time << " seconds" << endl;
     }
 
-    // eventThread, replanThread在此示範不特別join或結束，實務可加條件中斷。
+    SearchContext::Totals st = SearchContext::totals();
+    cout << "[search workspace] searches=" << st.searches << ", expansions=" << st.expansions << " ("
+         << (st.searches ? (double)st.expansions / st.searches : 0.0) << "/query, "
+         << (alt ? "ALT, " + to_string(parkingLot.landmarkRebuilds()) + " field rebuilds" : string("Manhattan"))
+         << "), allocations=" << st.allocations
+         << ", avoided allocations~" << st.avoidedAllocations << " (" << st.avoidedBytes / 1024 << " KB)\n";
+    parkingLot.printIncrementalStats();
+    parkingLot.printRouteCacheStats();
+    parkingLot.stopReplanDispatcher();
+
+    if (!searchStatsPath.empty()) {
+        if (!SearchStats::enabled())
+            cout << "--search-stats ignored: built without SEARCH_STATS (cmake -DSEARCH_STATS=ON)\n";
+        else if (!SearchStats::exportFile(searchStatsPath))
+            cout << "Cannot write " << searchStatsPath << "\n";
+        else
+            cout << "Search stats: " << SearchStats::count() << " searches => " << searchStatsPath << "\n";
+    }
 
     return 0;
 }
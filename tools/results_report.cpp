@@ -0,0 +1,748 @@
+// results_report：scripts/plot_results.py 的 C++ 版 (同樣的圖、同樣的百分位數)，給 50k 列以上的結果 CSV 用
+//   讀檔：mmap 整個 CSV，資料列切成固定大小 (CHUNK) 的區塊，在 work-stealing pool 上平行解析；
+//         分隔字元一次看 8 bytes (SWAR：一個 uint64 裡找 ',' 與 '\n')，數字以 std::from_chars 轉換
+//   欄位：與 read_numeric_columns 相同，每格去掉前後空白後能轉成數字的才算 (空字串、文字略過)；
+//         不支援含逗號的引號欄位 (results CSV 不會出現)
+//   統計：每個數值欄位 (含 *_pct) 的個數、平均、標準差、平均的 95% CI、min / p5 / p25 / p50 / p75 / p95 / max，
+//         欄位格式與 250604statisticlog --summary 相同；百分位數與 plot_results.py 的 percentile() 相同 (排序後線性內插)
+//   圖：delay_hist.png (名稱含 delay 的欄位，每欄 20 格直方圖) 與 runtime_boxplot.png (名稱含 time 的欄位)，
+//       不含 pct 欄；版面、字型、座標的取整與 plot_results.py 逐像素相同
+//       PNG 每列選 Up (與上一列相同時整列為 0) 或 Sub filter，再以 fixed Huffman + 距離 1 的重複長度壓縮
+//
+// 參數：[--input results/results_cleaned_forPAPER.csv] [--output docs/figs] [--threads T] [--summary FILE]
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "mapped_file.hpp"
+#include "stream_stats.hpp"
+#include "work_steal_pool.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+// ---------------------------------------------------------------------------
+// CSV 解析
+// ---------------------------------------------------------------------------
+static const size_t CHUNK = 1 << 18; // 區塊大小固定 => 結果與執行緒數無關
+
+// 每個 byte 是否等於 c：回傳值中對應 byte 的最高位為 1 (只保證最低的那一個正確，夠用來找第一個)
+static inline uint64_t byteEq(uint64_t w, char c) {
+    uint64_t x = w ^ (0x0101010101010101ULL * (uint8_t)c);
+    return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+}
+
+static inline int firstByte(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, mask);
+    return (int)(i >> 3);
+#else
+    return __builtin_ctzll(mask) >> 3;
+#endif
+}
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// 常見的 "-12.34" (15 位數以內、沒有指數)：整數部分與小數位數都是精確值，一次除法即為正確捨入 (Clinger fast path)，
+// 與 from_chars 的結果逐位元相同；其他寫法回傳 false 交給 from_chars
+static inline bool parseSimpleDecimal(const char *b, const char *e, double &out) {
+    static const double POW10[16] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                     1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    bool neg = *b == '-';
+    if (neg) ++b;
+    uint64_t mant = 0;
+    int digits = 0, frac = -1;
+    for (; b < e; ++b) {
+        unsigned d = (unsigned)(*b - '0');
+        if (d < 10) {
+            mant = mant * 10 + d;
+            ++digits;
+            if (frac >= 0) ++frac;
+        } else if (*b == '.' && frac < 0) {
+            frac = 0;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0 || digits > 15) return false;
+    double v = (double)mant;
+    if (frac > 0) v /= POW10[frac];
+    out = neg ? -v : v;
+    return true;
+}
+
+// 與 Python 的 float(value.strip()) 相同的數字 (另外允許整格以雙引號包住)；不是數字時回傳 false
+static bool parseNumber(const char *b, const char *e, double &out) {
+    if (e - b >= 2 && *b == '"' && e[-1] == '"') {
+        ++b;
+        --e;
+    }
+    while (b < e && isSpace(*b)) ++b;
+    while (e > b && isSpace(e[-1])) --e;
+    if (b == e) return false;
+    if (*b == '+' && e - b > 1 && b[1] != '-' && b[1] != '+') ++b;
+    if (parseSimpleDecimal(b, e, out)) return true;
+    auto res = from_chars(b, e, out);
+    return res.ec == errc() && res.ptr == e;
+}
+
+struct Chunk {
+    vector<vector<double>> values; // [欄位] => 這個區塊裡依列順序的數值
+    size_t rows = 0;
+};
+
+// [begin, end) 都是完整的列 (最後一列可能沒有換行)
+static void parseChunk(const char *base, size_t begin, size_t end, size_t columns, Chunk &out) {
+    out.values.assign(columns, {});
+    size_t pos = begin, fieldStart = begin, field = 0;
+    bool rowHasData = false;
+    auto finishField = [&](size_t stop) {
+        if (stop > fieldStart && !(stop == fieldStart + 1 && base[fieldStart] == '\r')) rowHasData = true;
+        double v;
+        if (field < columns && parseNumber(base + fieldStart, base + stop, v)) out.values[field].push_back(v);
+    };
+    while (pos < end) {
+        if (pos + 8 <= end) {
+            uint64_t w;
+            memcpy(&w, base + pos, 8);
+            uint64_t m = byteEq(w, ',') | byteEq(w, '\n');
+            if (!m) {
+                pos += 8;
+                continue;
+            }
+            pos += firstByte(m);
+        } else if (base[pos] != ',' && base[pos] != '\n') {
+            ++pos;
+            continue;
+        }
+        finishField(pos);
+        if (base[pos] == '\n') {
+            if (rowHasData) out.rows++;
+            field = 0;
+            rowHasData = false;
+        } else {
+            ++field;
+        }
+        fieldStart = ++pos;
+    }
+    if (fieldStart < end) {
+        finishField(end);
+        if (rowHasData) out.rows++;
+    }
+}
+
+struct Column {
+    string name;
+    vector<double> values; // 依檔案中的列順序；統計完後只保證 percentile() 用到的名次在正確位置 (見 selectRanks)
+    RunningStats stats;
+};
+
+// 讀整個 CSV：第一列為欄名，其餘切成區塊平行解析，再依區塊順序把每欄接起來
+static bool readNumericColumns(const string &path, WorkStealingPool &pool, vector<Column> &cols, size_t &rows,
+                               size_t &bytes, string &err) {
+    MappedFile file;
+    if (!file.open(path, err)) return false;
+    const char *base = (const char *)file.data();
+    size_t size = file.size();
+    bytes = size;
+
+    const char *nl = (const char *)memchr(base, '\n', size);
+    size_t headerEnd = nl ? (size_t)(nl - base) : size;
+    size_t bodyStart = nl ? headerEnd + 1 : size;
+    cols.clear();
+    size_t s = 0;
+    for (size_t i = 0; i <= headerEnd; ++i) {
+        if (i == headerEnd || base[i] == ',') {
+            size_t e = i;
+            if (e > s && base[e - 1] == '\r') --e;
+            string name(base + s, e - s);
+            if (name.size() >= 2 && name.front() == '"' && name.back() == '"') name = name.substr(1, name.size() - 2);
+            cols.push_back({name, {}, {}});
+            s = i + 1;
+        }
+    }
+
+    // 區塊邊界往後移到下一個換行之後
+    vector<pair<size_t, size_t>> ranges;
+    for (size_t b = bodyStart; b < size;) {
+        size_t e = min(size, b + CHUNK);
+        if (e < size) {
+            const char *p = (const char *)memchr(base + e, '\n', size - e);
+            e = p ? (size_t)(p - base) + 1 : size;
+        }
+        ranges.emplace_back(b, e);
+        b = e;
+    }
+    vector<Chunk> chunks(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i)
+        pool.submit([&, i]() { parseChunk(base, ranges[i].first, ranges[i].second, cols.size(), chunks[i]); });
+    pool.wait();
+
+    rows = 0;
+    for (auto &c : chunks) rows += c.rows;
+    for (size_t k = 0; k < cols.size(); ++k) {
+        pool.submit([&, k]() {
+            size_t n = 0;
+            for (auto &c : chunks) n += c.values[k].size();
+            vector<double> &v = cols[k].values;
+            v.reserve(n);
+            for (auto &c : chunks) {
+                v.insert(v.end(), c.values[k].begin(), c.values[k].end());
+                vector<double>().swap(c.values[k]);
+            }
+        });
+    }
+    pool.wait();
+    // 與 read_numeric_columns 相同：沒有任何數值的欄位不算
+    cols.erase(remove_if(cols.begin(), cols.end(), [](const Column &c) { return c.values.empty(); }), cols.end());
+    return true;
+}
+
+// 報表與圖用到的百分位數 (0 與 100 取 min / max，不讀 values)
+static const double PERCENTILES[5] = {5, 25, 50, 75, 95};
+
+// plot_results.py 的 percentile()：q 為 0..100；sorted 只需在 floor(pos) / ceil(pos) 的名次上放對元素
+static double percentile(const vector<double> &sorted, double q) {
+    if (q <= 0) return *min_element(sorted.begin(), sorted.end());
+    if (q >= 100) return *max_element(sorted.begin(), sorted.end());
+    double pos = (double)(sorted.size() - 1) * q / 100.0;
+    double lower = floor(pos), upper = ceil(pos);
+    if (lower == upper) return sorted[(size_t)pos];
+    double fraction = pos - lower;
+    return sorted[(size_t)lower] + (sorted[(size_t)upper] - sorted[(size_t)lower]) * fraction;
+}
+
+// 把 PERCENTILES 會讀到的名次放到排序後的位置：先以中間的名次做 nth_element，左右兩段再各自遞迴
+// => 平均 O(n log k)，不必整欄排序
+static void selectRanks(vector<double> &v, const size_t *ranks, size_t n, size_t lo, size_t hi) {
+    if (n == 0) return;
+    size_t mid = n / 2, r = ranks[mid];
+    nth_element(v.begin() + lo, v.begin() + r, v.begin() + hi);
+    selectRanks(v, ranks, mid, lo, r);
+    selectRanks(v, ranks + mid + 1, n - mid - 1, r + 1, hi);
+}
+
+static void selectRanks(vector<double> &v) {
+    vector<size_t> ranks;
+    for (double q : PERCENTILES) {
+        double pos = (double)(v.size() - 1) * q / 100.0;
+        ranks.push_back((size_t)floor(pos));
+        ranks.push_back((size_t)ceil(pos));
+    }
+    sort(ranks.begin(), ranks.end());
+    ranks.erase(unique(ranks.begin(), ranks.end()), ranks.end());
+    selectRanks(v, ranks.data(), ranks.size(), 0, v.size());
+}
+
+// ---------------------------------------------------------------------------
+// Canvas + PNG
+// ---------------------------------------------------------------------------
+struct Color {
+    uint8_t r, g, b;
+};
+
+// 5×7 點陣字，與 plot_results.py 的 FONT 相同 (每列 5 bit，最高位在左)
+struct Glyph {
+    char ch;
+    uint8_t rows[7];
+};
+static const Glyph FONT[] = {
+    {' ', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+    {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+    {'3', {0x1E, 0x01, 0x01, 0x0E, 0x01, 0x01, 0x1E}},
+    {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+    {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+    {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+    {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+    {'A', {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+    {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+    {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+    {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+    {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+    {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'J', {0x07, 0x02, 0x02, 0x02, 0x12, 0x12, 0x0C}},
+    {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+    {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+    {'M', {0x11, 0x1B, 0x15, 0x11, 0x11, 0x11, 0x11}},
+    {'N', {0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+    {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+    {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+    {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'V', {0x11, 0x11, 0x11, 0x11, 0x0A, 0x0A, 0x04}},
+    {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+    {'X', {0x11, 0x0A, 0x04, 0x04, 0x04, 0x0A, 0x11}},
+    {'Y', {0x11, 0x0A, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+    {':', {0x00, 0x04, 0x04, 0x00, 0x04, 0x04, 0x00}},
+    {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x06}},
+    {'-', {0x00, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00}},
+    {'/', {0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00}},
+};
+
+class Canvas {
+public:
+    Canvas(int width, int height) : w(width), h(height), px((size_t)width * height * 3, 255) {}
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    void setPixel(int x, int y, Color c) {
+        if (x < 0 || x >= w || y < 0 || y >= h) return;
+        uint8_t *p = &px[((size_t)y * w + x) * 3];
+        p[0] = c.r;
+        p[1] = c.g;
+        p[2] = c.b;
+    }
+
+    void fillRect(int x0, int y0, int x1, int y1, Color c) {
+        if (x0 > x1) swap(x0, x1);
+        if (y0 > y1) swap(y0, y1);
+        for (int y = max(0, y0); y < min(h, y1); ++y)
+            for (int x = max(0, x0); x < min(w, x1); ++x) setPixel(x, y, c);
+    }
+
+    void strokeRect(int x0, int y0, int x1, int y1, Color c) {
+        fillRect(x0, y0, x1, y0 + 1, c);
+        fillRect(x0, y1 - 1, x1, y1, c);
+        fillRect(x0, y0, x0 + 1, y1, c);
+        fillRect(x1 - 1, y0, x1, y1, c);
+    }
+
+    void drawText(int x, int y, const string &text, Color c, int scale = 2) {
+        int cursor = x;
+        for (char ch : text) {
+            const Glyph *g = glyph((char)toupper((unsigned char)ch));
+            for (int row = 0; row < 7; ++row) {
+                for (int col = 0; col < 5; ++col) {
+                    if (!(g->rows[row] & (0x10 >> col))) continue;
+                    for (int dy = 0; dy < scale; ++dy)
+                        for (int dx = 0; dx < scale; ++dx) setPixel(cursor + col * scale + dx, y + row * scale + dy, c);
+                }
+            }
+            cursor += 6 * scale;
+        }
+    }
+
+    bool writePng(const string &path) const;
+
+private:
+    static const Glyph *glyph(char ch) {
+        for (const Glyph &g : FONT)
+            if (g.ch == ch) return &g;
+        return &FONT[0]; // 沒有的字元畫成空白
+    }
+
+    int w, h;
+    vector<uint8_t> px; // RGB
+};
+
+// zlib 串流：單一 fixed Huffman 區塊，只用 literal 與「距離 1」的重複 (連續相同的 byte)
+class DeflateWriter {
+public:
+    explicit DeflateWriter(vector<uint8_t> &out) : out(out) {
+        out.push_back(0x78);
+        out.push_back(0x01);
+        bits(1, 1); // BFINAL
+        bits(1, 2); // BTYPE = 01 (fixed Huffman)
+    }
+
+    void write(const uint8_t *p, size_t n) {
+        for (size_t i = 0; i < n;) {
+            size_t run = 0;
+            if (havePrev) {
+                while (i + run < n && p[i + run] == prev && run < 258) ++run;
+            }
+            if (run >= 3) {
+                lengthCode((int)run);
+                bits(0, 5); // 距離 1 => distance code 0，沒有 extra bits
+                i += run;
+            } else {
+                literal(p[i]);
+                prev = p[i];
+                havePrev = true;
+                ++i;
+            }
+        }
+        // Adler-32：每 5552 bytes 取一次餘數 (不會溢位的最大長度)
+        for (size_t i = 0; i < n;) {
+            size_t stop = min(n, i + 5552);
+            for (; i < stop; ++i) {
+                s1 += p[i];
+                s2 += s1;
+            }
+            s1 %= 65521;
+            s2 %= 65521;
+        }
+    }
+
+    void finish() {
+        huffman(0, 7); // end of block (256)
+        if (nbits) out.push_back((uint8_t)acc);
+        acc = 0;
+        nbits = 0;
+        uint32_t adler = (s2 << 16) | s1;
+        for (int s = 24; s >= 0; s -= 8) out.push_back((uint8_t)(adler >> s));
+    }
+
+private:
+    void bits(uint32_t v, int n) {
+        acc |= (uint64_t)v << nbits;
+        nbits += n;
+        while (nbits >= 8) {
+            out.push_back((uint8_t)acc);
+            acc >>= 8;
+            nbits -= 8;
+        }
+    }
+
+    // Huffman 碼由最高位開始寫
+    void huffman(uint32_t code, int len) {
+        uint32_t rev = 0;
+        for (int i = 0; i < len; ++i) rev |= ((code >> i) & 1u) << (len - 1 - i);
+        bits(rev, len);
+    }
+
+    void literal(uint8_t v) {
+        if (v < 144) huffman(0x30 + v, 8);
+        else huffman(0x190 + (v - 144), 9);
+    }
+
+    void lengthCode(int len) {
+        static const int BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                     31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        int k = 28;
+        while (BASE[k] > len) --k;
+        int sym = 257 + k;
+        if (sym < 280) huffman((uint32_t)(sym - 256), 7);
+        else huffman((uint32_t)(0xC0 + (sym - 280)), 8);
+        if (EXTRA[k]) bits((uint32_t)(len - BASE[k]), EXTRA[k]);
+    }
+
+    vector<uint8_t> &out;
+    uint64_t acc = 0;
+    int nbits = 0;
+    uint8_t prev = 0;
+    bool havePrev = false;
+    uint32_t s1 = 1, s2 = 0;
+};
+
+static uint32_t crc32(const uint8_t *p, size_t n, uint32_t crc = 0) {
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void pngChunk(vector<uint8_t> &png, const char *tag, const vector<uint8_t> &data) {
+    uint32_t n = (uint32_t)data.size();
+    for (int s = 24; s >= 0; s -= 8) png.push_back((uint8_t)(n >> s));
+    size_t start = png.size();
+    png.insert(png.end(), tag, tag + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    uint32_t crc = crc32(&png[start], png.size() - start);
+    for (int s = 24; s >= 0; s -= 8) png.push_back((uint8_t)(crc >> s));
+}
+
+bool Canvas::writePng(const string &path) const {
+    vector<uint8_t> idat, row((size_t)w * 3 + 1);
+    DeflateWriter z(idat);
+    size_t stride = (size_t)w * 3;
+    for (int y = 0; y < h; ++y) {
+        const uint8_t *cur = &px[(size_t)y * stride];
+        if (y > 0 && memcmp(cur, cur - stride, stride) == 0) {
+            row[0] = 2; // Up：整列為 0
+            fill(row.begin() + 1, row.end(), 0);
+        } else {
+            row[0] = 1; // Sub：與左邊像素的差
+            for (size_t i = 0; i < stride; ++i) row[1 + i] = (uint8_t)(cur[i] - (i >= 3 ? cur[i - 3] : 0));
+        }
+        z.write(row.data(), row.size());
+    }
+    z.finish();
+
+    vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    vector<uint8_t> ihdr;
+    for (uint32_t v : {(uint32_t)w, (uint32_t)h})
+        for (int s = 24; s >= 0; s -= 8) ihdr.push_back((uint8_t)(v >> s));
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0}); // 8-bit RGB
+    pngChunk(png, "IHDR", ihdr);
+    pngChunk(png, "IDAT", idat);
+    pngChunk(png, "IEND", {});
+
+    error_code ec;
+    filesystem::path p(path);
+    if (p.has_parent_path()) filesystem::create_directories(p.parent_path(), ec);
+    ofstream f(path, ios::binary);
+    f.write((const char *)png.data(), (streamsize)png.size());
+    return (bool)f;
+}
+
+// ---------------------------------------------------------------------------
+// 圖 (與 plot_results.py 的 draw_histograms / draw_boxplots 相同)
+// ---------------------------------------------------------------------------
+static string formatLabel(string name) {
+    for (char &c : name) c = c == '_' ? ' ' : (char)toupper((unsigned char)c);
+    return name;
+}
+
+static string fixed2(const char *prefix, double v) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s%.2f", prefix, v);
+    return buf;
+}
+
+// math.isclose 的預設值 (rel_tol = 1e-9)
+static bool isClose(double a, double b) {
+    return fabs(a - b) <= 1e-9 * max(fabs(a), fabs(b));
+}
+
+static void drawHistograms(Canvas &canvas, const vector<const Column *> &columns, int left, int top, int right,
+                           int bottom) {
+    const Color heading = {33, 33, 33}, axis = {120, 120, 120}, bar = {79, 129, 189};
+    int rowHeight = (bottom - top) / max(1, (int)columns.size());
+    for (size_t idx = 0; idx < columns.size(); ++idx) {
+        const Column &col = *columns[idx];
+        int rowTop = top + (int)idx * rowHeight;
+        int chartTop = rowTop + 40;
+        int chartBottom = min(bottom, rowTop + rowHeight - 20);
+        int chartLeft = left + 100;
+        int chartRight = right - 40;
+        canvas.drawText(chartLeft, rowTop + 5, formatLabel(col.name), heading);
+        canvas.strokeRect(chartLeft, chartTop, chartRight, chartBottom, axis);
+        double minVal = col.stats.min(), maxVal = col.stats.max();
+        if (isClose(minVal, maxVal)) maxVal = minVal + 1;
+        const int bins = 20;
+        vector<long long> counts(bins, 0);
+        double span = maxVal - minVal;
+        for (double v : col.values) {
+            double ratio = (v - minVal) / span;
+            counts[min(bins - 1, max(0, (int)(ratio * bins)))]++;
+        }
+        long long maxCount = max(*max_element(counts.begin(), counts.end()), 1LL);
+        double binWidth = (double)(chartRight - chartLeft) / bins;
+        for (int b = 0; b < bins; ++b) {
+            int barHeight = (int)(((double)counts[b] / (double)maxCount) * (chartBottom - chartTop - 4));
+            int x0 = (int)(chartLeft + b * binWidth) + 1;
+            int x1 = (int)(chartLeft + (b + 1) * binWidth) - 1;
+            int y0 = chartBottom - barHeight;
+            canvas.fillRect(x0, y0, max(x0 + 1, x1), chartBottom - 1, bar);
+        }
+        canvas.drawText(chartRight - 200, rowTop + 5, fixed2("AVG: ", col.stats.mean()), heading);
+    }
+}
+
+static void drawBoxplots(Canvas &canvas, const vector<const Column *> &columns, int left, int top, int right,
+                         int bottom) {
+    const Color heading = {33, 33, 33}, axis = {120, 120, 120}, box = {203, 75, 75}, whisker = {60, 60, 60};
+    if (columns.empty()) return;
+    double minVal = columns[0]->stats.min(), maxVal = columns[0]->stats.max();
+    for (const Column *c : columns) {
+        minVal = min(minVal, c->stats.min());
+        maxVal = max(maxVal, c->stats.max());
+    }
+    if (isClose(minVal, maxVal)) maxVal = minVal + 1;
+    double span = maxVal - minVal;
+    int plotLeft = left + 120, plotRight = right - 80, plotTop = top + 20, plotBottom = bottom - 80;
+    canvas.strokeRect(plotLeft, plotTop, plotRight, plotBottom, axis);
+    canvas.drawText(plotLeft, top > 20 ? top - 10 : 5, "RUNTIME BOXPLOT", heading);
+
+    double columnWidth = (double)(plotRight - plotLeft) / max(1, (int)columns.size());
+    auto yFor = [&](double v) { return (int)(plotBottom - (v - minVal) / span * (plotBottom - plotTop)); };
+    for (size_t idx = 0; idx < columns.size(); ++idx) {
+        const Column &col = *columns[idx];
+        double q1 = percentile(col.values, 25), median = percentile(col.values, 50), q3 = percentile(col.values, 75);
+        double iqr = q3 - q1;
+        double lowerWhisker = max(col.stats.min(), q1 - 1.5 * iqr);
+        double upperWhisker = min(col.stats.max(), q3 + 1.5 * iqr);
+
+        double xCenter = plotLeft + columnWidth * (idx + 0.5);
+        int halfWidth = max(10, (int)(columnWidth / 4));
+        int yQ1 = yFor(q1), yQ3 = yFor(q3), yMed = yFor(median), yLow = yFor(lowerWhisker),
+            yHigh = yFor(upperWhisker);
+        int xl = (int)(xCenter - halfWidth), xr = (int)(xCenter + halfWidth), xc = (int)xCenter;
+
+        canvas.fillRect(xl, yQ3, xr, yQ1, box);
+        canvas.fillRect(xl, yMed, xr, yMed + 2, whisker);
+        canvas.fillRect(xc, yHigh, xc + 1, yQ3, whisker);
+        canvas.fillRect(xc, yQ1, xc + 1, yLow, whisker);
+        canvas.fillRect(xl, yHigh, xr, yHigh + 1, whisker);
+        canvas.fillRect(xl, yLow, xr, yLow + 1, whisker);
+
+        canvas.drawText(xl, plotBottom + 20, formatLabel(col.name), heading);
+        canvas.drawText(xl, plotBottom + 50, fixed2("MED: ", median), heading);
+    }
+}
+
+// plot_results.py 的 select_columns：名稱含 needle、不含 pct，依名稱排序
+static vector<const Column *> selectColumns(const vector<Column> &cols, const string &needle) {
+    vector<const Column *> out;
+    for (const Column &c : cols) {
+        string lower = c.name;
+        for (char &ch : lower) ch = (char)tolower((unsigned char)ch);
+        if (lower.find(needle) != string::npos && lower.find("pct") == string::npos) out.push_back(&c);
+    }
+    sort(out.begin(), out.end(), [](const Column *a, const Column *b) { return a->name < b->name; });
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// 統計表 (與 250604statisticlog --summary 相同的欄位)
+// ---------------------------------------------------------------------------
+static void printSummary(const vector<Column> &cols) {
+    char line[200];
+    snprintf(line, sizeof(line), "%-16s %9s %10s %9s %9s %9s %9s %9s %9s %9s %9s\n", "column", "n", "mean", "sd",
+             "min", "p5", "p25", "p50", "p75", "p95", "max");
+    cout << line;
+    for (const Column &c : cols) {
+        snprintf(line, sizeof(line), "%-16s %9zu %10.3f %9.3f %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                 c.name.c_str(), c.values.size(), c.stats.mean(), c.stats.stddev(), c.stats.min(),
+                 percentile(c.values, 5), percentile(c.values, 25), percentile(c.values, 50),
+                 percentile(c.values, 75), percentile(c.values, 95), c.stats.max());
+        cout << line;
+    }
+}
+
+static bool writeSummary(const string &path, const vector<Column> &cols) {
+    ofstream out(path);
+    if (!out) return false;
+    char num[32];
+    auto put = [&](double v) {
+        snprintf(num, sizeof(num), "%.10g", v);
+        out << ',' << num;
+    };
+    out << "column,n,mean,sd,ci95_low,ci95_high,min,p5,p25,p50,p75,p95,max\n";
+    for (const Column &c : cols) {
+        out << c.name << ',' << c.values.size();
+        double half = c.stats.ci95HalfWidth();
+        put(c.stats.mean());
+        put(c.stats.stddev());
+        if (isnan(half)) {
+            out << ",,";
+        } else {
+            put(c.stats.mean() - half);
+            put(c.stats.mean() + half);
+        }
+        put(c.stats.min());
+        for (double q : PERCENTILES) put(percentile(c.values, q));
+        put(c.stats.max());
+        out << '\n';
+    }
+    return (bool)out;
+}
+
+int main(int argc, char *argv[]) {
+    string input = "results/results_cleaned_forPAPER.csv";
+    string output = "docs/figs";
+    string summaryPath;
+    unsigned threads = thread::hardware_concurrency();
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        if (arg == "--input" && a + 1 < argc) input = argv[++a];
+        else if (arg == "--output" && a + 1 < argc) output = argv[++a];
+        else if (arg == "--threads" && a + 1 < argc) threads = (unsigned)strtoul(argv[++a], nullptr, 10);
+        else if (arg == "--summary" && a + 1 < argc) summaryPath = argv[++a];
+    }
+
+    WorkStealingPool pool(threads);
+    auto t0 = steady_clock::now();
+    vector<Column> cols;
+    size_t rows = 0, bytes = 0;
+    string err;
+    if (!readNumericColumns(input, pool, cols, rows, bytes, err)) {
+        cerr << "CSV file not found: " << input << " (" << err << ")\n";
+        return 1;
+    }
+    auto t1 = steady_clock::now();
+
+    // 平均 / 標準差依檔案中的順序累計 (與 Python 的 sum() 相同)，之後再挑出百分位數的名次
+    for (size_t k = 0; k < cols.size(); ++k) {
+        pool.submit([&, k]() {
+            Column &c = cols[k];
+            for (double v : c.values) c.stats.add(v);
+            selectRanks(c.values);
+        });
+    }
+    pool.wait();
+    auto t2 = steady_clock::now();
+
+    vector<const Column *> delayColumns = selectColumns(cols, "delay");
+    vector<const Column *> timeColumns = selectColumns(cols, "time");
+    bool ok = true;
+    if (delayColumns.empty()) {
+        cout << "No delay columns detected; nothing to plot.\n";
+    } else {
+        Canvas canvas(1200, 200 * (int)delayColumns.size() + 120);
+        canvas.drawText(40, 20, "DELAY HISTOGRAMS", {33, 33, 33}, 3);
+        drawHistograms(canvas, delayColumns, 20, 80, canvas.width() - 20, canvas.height() - 20);
+        ok &= canvas.writePng(output + "/delay_hist.png");
+    }
+    if (timeColumns.empty()) {
+        cout << "No time columns detected; nothing to plot for runtime.\n";
+    } else {
+        Canvas canvas(1200, 600);
+        drawBoxplots(canvas, timeColumns, 20, 120, canvas.width() - 20, canvas.height() - 20);
+        ok &= canvas.writePng(output + "/runtime_boxplot.png");
+    }
+    auto t3 = steady_clock::now();
+
+    auto ms = [](steady_clock::time_point a, steady_clock::time_point b) {
+        return duration<double, milli>(b - a).count();
+    };
+    cout << input << ": " << rows << " rows, " << cols.size() << " numeric columns, " << bytes / 1024
+         << " KB on " << pool.size() << " threads (parse " << ms(t0, t1) << " ms, stats " << ms(t1, t2)
+         << " ms, png " << ms(t2, t3) << " ms)\n";
+    printSummary(cols);
+    if (!ok) {
+        cerr << "cannot write figures to " << output << "\n";
+        return 1;
+    }
+    cout << "Figures => " << output << "/delay_hist.png, " << output << "/runtime_boxplot.png\n";
+    if (!summaryPath.empty()) {
+        if (!writeSummary(summaryPath, cols)) {
+            cerr << "cannot write " << summaryPath << "\n";
+            return 1;
+        }
+        cout << "Summary => " << summaryPath << "\n";
+    }
+    return 0;
+}
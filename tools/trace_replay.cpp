@@ -0,0 +1,293 @@
+// trace_replay：檢視 --trace 寫出的軌跡檔 (include/trace_log.hpp)
+//   info            檔案大小、tick 數、keyframe 數、事件統計
+//   show T          tick T 結束時的地圖 (keyframe 索引直接定位，不從頭重播)、行駛中的車輛與該 tick 的事件
+//   cell R C        格子 (R, C) 的 type / waitTime / 經過的車輛隨時間的變化
+//   queues [N]      車輛停住不動最多的 N 個格子 (不含車輛最後停下倒車的那一格)
+//   waits           每個 tick 的 waitTime 概況 (CSV：tick, 非 0 格數, 總和, 最大值)
+//   verify          每個 tick 紀錄都以 seek 重建一次，與從頭重播的狀態比對
+//
+// 參數：trace_replay FILE [info | show T | cell R C | queues [N] | waits | verify]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "trace_log.hpp"
+#include "vehicle_table.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+static const char *eventName(TraceEvent kind) {
+    switch (kind) {
+    case TraceEvent::Close: return "close";
+    case TraceEvent::Reopen: return "reopen";
+    case TraceEvent::Replan: return "replan";
+    case TraceEvent::Arrive: return "arrive";
+    }
+    return "?";
+}
+
+static string cellName(const TraceReader &tr, uint32_t cell) {
+    return "(" + to_string(cell / tr.cols()) + "," + to_string(cell % tr.cols()) + ")";
+}
+
+static string describe(const TraceReader &tr, const TraceEventRecord &e) {
+    switch (e.kind) {
+    case TraceEvent::Close:
+    case TraceEvent::Reopen: return string(eventName(e.kind)) + " " + cellName(tr, e.a);
+    case TraceEvent::Replan:
+        return "replan V" + to_string(e.a) + (e.b ? " => " + to_string(e.b) + " cells" : string(" => no path"));
+    case TraceEvent::Arrive: return "arrive V" + to_string(e.a) + " after " + to_string(e.b) + " ticks";
+    }
+    return "?";
+}
+
+static int info(const TraceReader &tr) {
+    uint64_t counts[5] = {};
+    uint64_t cellChanges = 0, vehicleMoves = 0;
+    size_t vehicles = 0;
+    auto t0 = steady_clock::now();
+    bool ok = tr.replay([&](const TraceTick &tk, const TraceState &s) {
+        cellChanges += tk.cells.size();
+        vehicleMoves += tk.vehicles.size();
+        for (const TraceEventRecord &e : tk.events) counts[(int)e.kind < 5 ? (int)e.kind : 0]++;
+        vehicles = max(vehicles, s.vehicleCell.size());
+    });
+    double ms = duration<double, milli>(steady_clock::now() - t0).count();
+    if (!ok) {
+        cerr << "corrupt trace\n";
+        return 1;
+    }
+    cout << "lot " << tr.rows() << "x" << tr.cols() << ", " << tr.fileSize() << " bytes\n";
+    cout << "ticks: " << tr.tickRecords() << " records, last tick " << tr.lastTick() << " ("
+         << (tr.tickRecords() ? (double)tr.fileSize() / tr.tickRecords() : 0.0) << " bytes/record)\n";
+    cout << "keyframes: " << tr.keyframeCount() << " (every " << tr.keyframeTicks() << " ticks, " << tr.slotCount()
+         << " index slots)\n";
+    cout << "vehicles: " << (vehicles ? vehicles - 1 : 0) << " ids, " << vehicleMoves << " position changes\n";
+    cout << "cell changes: " << cellChanges << "\n";
+    cout << "events: close=" << counts[1] << ", reopen=" << counts[2] << ", replan=" << counts[3]
+         << ", arrive=" << counts[4] << "\n";
+    cout << "full replay: " << ms << " ms\n";
+    return 0;
+}
+
+// 與模擬程式的 displayStatus 相同的版面；waitTime > 0 顯示個位數，行駛中的車輛以字母顯示
+static int show(const TraceReader &tr, long long tick) {
+    TraceState s;
+    TraceTick applied;
+    auto t0 = steady_clock::now();
+    if (!tr.seek(tick, s, &applied)) {
+        cerr << "corrupt trace\n";
+        return 1;
+    }
+    double us = duration<double, micro>(steady_clock::now() - t0).count();
+    vector<VehicleId> at((size_t)tr.rows() * tr.cols(), NO_VEHICLE);
+    vector<VehicleId> driving;
+    for (VehicleId id = 1; id < s.vehicleCell.size(); ++id) {
+        if (!s.vehicleCell[id]) continue;
+        at[s.vehicleCell[id] - 1] = id;
+        driving.push_back(id);
+    }
+    cout << "t=" << tick << " (state after tick " << s.tick << ", seek " << us << " us)\n";
+    cout << "  ";
+    for (int c = 0; c < tr.cols(); ++c) cout << (c % 10) << " ";
+    cout << "\n";
+    for (int r = 0; r < tr.rows(); ++r) {
+        cout << (r % 10) << " ";
+        for (int c = 0; c < tr.cols(); ++c) {
+            size_t i = (size_t)r * tr.cols() + c;
+            char ch = tr.glyph(s.type[i]);
+            if (s.wait[i] > 0) ch = (char)('0' + s.wait[i] % 10);
+            else if (at[i] != NO_VEHICLE) ch = vehicleGlyph(at[i], VehicleRole::Arriving);
+            cout << ch << " ";
+        }
+        cout << "\n";
+    }
+    cout << driving.size() << " vehicle(s) driving:";
+    for (VehicleId id : driving) cout << " V" << id << cellName(tr, s.vehicleCell[id] - 1);
+    cout << "\n";
+    // 這個 tick 自己的事件
+    if (applied.tick == tick) {
+        for (const TraceEventRecord &e : applied.events) cout << "event: " << describe(tr, e) << "\n";
+    }
+    return 0;
+}
+
+static int cellHistory(const TraceReader &tr, int r, int c) {
+    if (r < 0 || c < 0 || r >= tr.rows() || c >= tr.cols()) {
+        cerr << "cell outside the " << tr.rows() << "x" << tr.cols() << " lot\n";
+        return 1;
+    }
+    int cell = r * tr.cols() + c;
+    TraceState s;
+    tr.seek(-1, s);
+    cout << "start: type '" << tr.glyph(s.type[cell]) << "' (" << (int)s.type[cell] << "), wait=" << s.wait[cell]
+         << "\n";
+    vector<uint32_t> prevCell = s.vehicleCell;
+    bool ok = tr.replay([&](const TraceTick &tk, const TraceState &st) {
+        string line;
+        if (binary_search(tk.cells.begin(), tk.cells.end(), cell)) {
+            line += " type '" + string(1, tr.glyph(st.type[cell])) + "' (" + to_string(st.type[cell]) +
+                    "), wait=" + to_string(st.wait[cell]);
+        }
+        for (VehicleId id : tk.vehicles) {
+            uint32_t before = id < prevCell.size() ? prevCell[id] : 0;
+            uint32_t now = st.vehicleCell[id];
+            if (now == (uint32_t)cell + 1) line += " V" + to_string(id) + " enters";
+            else if (before == (uint32_t)cell + 1) line += " V" + to_string(id) + " leaves";
+        }
+        for (const TraceEventRecord &e : tk.events) {
+            bool here = (e.kind == TraceEvent::Close || e.kind == TraceEvent::Reopen) && e.a == (uint32_t)cell;
+            if (here) line += string(" [") + eventName(e.kind) + "]";
+        }
+        if (!line.empty()) cout << "t=" << tk.tick << ":" << line << "\n";
+        if (prevCell.size() < st.vehicleCell.size()) prevCell.resize(st.vehicleCell.size(), 0);
+        for (VehicleId id : tk.vehicles) prevCell[id] = st.vehicleCell[id];
+    });
+    return ok ? 0 : 1;
+}
+
+// 停住不動的車輛-tick：兩筆紀錄之間車輛位置沒變 (以 tick 差計)；
+//   車輛最後停下的格子 (倒車、抵達) 不算排隊
+static int queues(const TraceReader &tr, size_t top) {
+    size_t cells = (size_t)tr.rows() * tr.cols();
+    // 第一次重播：每台車每一段行駛最後所在的格子
+    vector<vector<uint32_t>> finalCells; // 車輛 -> 依序每一段的終點 (格子 + 1)
+    vector<uint32_t> prev;
+    bool ok = tr.replay([&](const TraceTick &tk, const TraceState &s) {
+        if (finalCells.size() < s.vehicleCell.size()) finalCells.resize(s.vehicleCell.size());
+        if (prev.size() < s.vehicleCell.size()) prev.resize(s.vehicleCell.size(), 0);
+        for (VehicleId id : tk.vehicles) {
+            if (s.vehicleCell[id] == 0 && prev[id] != 0) finalCells[id].push_back(prev[id]);
+            prev[id] = s.vehicleCell[id];
+        }
+    });
+    if (!ok) {
+        cerr << "corrupt trace\n";
+        return 1;
+    }
+
+    vector<uint64_t> waitTicks(cells, 0);
+    vector<uint32_t> waiters(cells, 0);
+    vector<size_t> segment(finalCells.size(), 0);
+    vector<uint32_t> lastCounted;
+    long long lastTick = 0;
+    prev.assign(finalCells.size(), 0);
+    vector<VehicleId> present;
+    tr.replay([&](const TraceTick &tk, const TraceState &s) {
+        if (lastCounted.size() < s.vehicleCell.size()) lastCounted.resize(s.vehicleCell.size(), 0);
+        if (prev.size() < s.vehicleCell.size()) prev.resize(s.vehicleCell.size(), 0);
+        if (segment.size() < s.vehicleCell.size()) segment.resize(s.vehicleCell.size(), 0);
+        // 上一筆紀錄之後停在原地的 tick 數：中間沒有紀錄的 tick，加上這個 tick (若仍在原地)
+        for (VehicleId id : present) {
+            uint32_t c = prev[id];
+            if (!c) continue;
+            const vector<uint32_t> &ends = finalCells[id];
+            if (segment[id] < ends.size() && ends[segment[id]] == c) continue; // 終點：倒車
+            long long stay = tk.tick - lastTick - (s.vehicleCell[id] != c ? 1 : 0);
+            if (stay <= 0) continue;
+            waitTicks[c - 1] += (uint64_t)stay;
+            if (lastCounted[id] != c) {
+                waiters[c - 1]++;
+                lastCounted[id] = c;
+            }
+        }
+        for (VehicleId id : tk.vehicles) {
+            if (s.vehicleCell[id] == 0 && prev[id] != 0) segment[id]++;
+            prev[id] = s.vehicleCell[id];
+        }
+        present.clear();
+        for (VehicleId id = 1; id < s.vehicleCell.size(); ++id)
+            if (s.vehicleCell[id]) present.push_back(id);
+        lastTick = tk.tick;
+    });
+
+    vector<size_t> order;
+    for (size_t i = 0; i < cells; ++i)
+        if (waitTicks[i]) order.push_back(i);
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return waitTicks[a] != waitTicks[b] ? waitTicks[a] > waitTicks[b] : a < b;
+    });
+    if (order.size() > top) order.resize(top);
+    uint64_t total = 0;
+    for (uint64_t w : waitTicks) total += w;
+    cout << "stationary vehicle-ticks (excluding parking): " << total << "\n";
+    char line[128];
+    snprintf(line, sizeof(line), "%-12s %14s %10s\n", "cell", "vehicle-ticks", "vehicles");
+    cout << line;
+    for (size_t i : order) {
+        snprintf(line, sizeof(line), "%-12s %14llu %10u\n", cellName(tr, (uint32_t)i).c_str(),
+                 (unsigned long long)waitTicks[i], waiters[i]);
+        cout << line;
+    }
+    return 0;
+}
+
+static int waits(const TraceReader &tr) {
+    cout << "tick,waiting_cells,wait_sum,wait_max\n";
+    bool ok = tr.replay([&](const TraceTick &tk, const TraceState &s) {
+        long long n = 0, sum = 0, mx = 0;
+        for (int w : s.wait) {
+            if (w <= 0) continue;
+            n++;
+            sum += w;
+            mx = max<long long>(mx, w);
+        }
+        cout << tk.tick << "," << n << "," << sum << "," << mx << "\n";
+    });
+    return ok ? 0 : 1;
+}
+
+static int verify(const TraceReader &tr) {
+    size_t checked = 0, mismatched = 0;
+    double seekUs = 0, worstUs = 0;
+    TraceState seeked;
+    bool ok = tr.replay([&](const TraceTick &tk, const TraceState &s) {
+        auto t0 = steady_clock::now();
+        bool found = tr.seek(tk.tick, seeked);
+        double us = duration<double, micro>(steady_clock::now() - t0).count();
+        seekUs += us;
+        worstUs = max(worstUs, us);
+        vector<uint32_t> a = s.vehicleCell, b = seeked.vehicleCell;
+        size_t n = max(a.size(), b.size());
+        a.resize(n, 0);
+        b.resize(n, 0);
+        if (!found || seeked.tick != tk.tick || seeked.type != s.type || seeked.wait != s.wait || a != b) {
+            if (mismatched++ < 5) cout << "mismatch at tick " << tk.tick << "\n";
+        }
+        checked++;
+    });
+    if (!ok) {
+        cerr << "corrupt trace\n";
+        return 1;
+    }
+    cout << checked << " ticks checked, " << mismatched << " mismatch(es); seek mean "
+         << (checked ? seekUs / checked : 0.0) << " us, max " << worstUs << " us\n";
+    return mismatched ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cerr << "usage: trace_replay FILE [info | show T | cell R C | queues [N] | waits | verify]\n";
+        return 1;
+    }
+    TraceReader tr;
+    string err;
+    if (!tr.open(argv[1], err)) {
+        cerr << argv[1] << ": " << err << "\n";
+        return 1;
+    }
+    string cmd = argc > 2 ? argv[2] : "info";
+    if (cmd == "info") return info(tr);
+    if (cmd == "show" && argc > 3) return show(tr, atoll(argv[3]));
+    if (cmd == "cell" && argc > 4) return cellHistory(tr, atoi(argv[3]), atoi(argv[4]));
+    if (cmd == "queues") return queues(tr, argc > 3 ? (size_t)atoi(argv[3]) : 10);
+    if (cmd == "waits") return waits(tr);
+    if (cmd == "verify") return verify(tr);
+    cerr << "unknown command: " << cmd << "\n";
+    return 1;
+}